@@ -4,11 +4,21 @@
 #include <linux/cdev.h>
 #include <linux/spi/spi.h>
 #include <linux/wait.h>
+#include <linux/mutex.h>
+#include <linux/seqlock.h>
+#include <linux/timer.h>
+#include <linux/workqueue.h>
 #include "vs10xx_queue.h"
+#include "vs10xx_spectrum.h"
+#include "vs10xx_watchdog.h"
+#include "vs10xx_stream.h"
+#include "vs10xx_model.h"
 #include <linux/gpio/consumer.h>
 
 #define VS10XX_MAX_DEVICES 2
 #define VS10XX_MAX_TRANSFER_SIZE 32
+#define VS10XX_SCI_BURST_MAX (VS10XX_SA_HDR_WORDS + VS10XX_SA_MAX_BANDS)
+
 
 /* Debugging */
 #ifdef VS10XX_DEBUG
@@ -47,9 +57,63 @@ struct vs10xx_chip {
 
     vs10xx_queue_t tx_pool_q; // vs10xx_queue_t  vs10xx_queue.h    ť ü̴.  ťȿ vs10xx_qel_t   ̵µ   32Ʈ ũ MP3͸   ִ.
                               //  α׷ write Լ  MP3 ͸ , ̹  tx_pool_q  ۸ ϳ  װ ͸ ä.
-    vs10xx_queue_t tx_data_q; // write Լ ͸ ä ۸  tx_data_q  ڿ  . ׷ ̹ SPI  Ʈ  ⿭  տ ۸ ϳ  ϵ 
+
+    struct mutex ctrl_lock;  // serializes users of msg/transfer/tx_buf/rx_buf and the burst buffers
+
+    /* Batched SCI reads (vs10xx_io_ctrl_rd_burst) */
+    struct spi_transfer burst_xfer[2 * VS10XX_SCI_BURST_MAX];
+    u8 burst_cmd[2];
+    u8 burst_rx[2 * VS10XX_SCI_BURST_MAX];
+
+    /* Spectrum analyzer readout, published through sa_lock */
+    seqlock_t sa_lock;
+    struct vs10xx_spectrum sa;
+    struct timer_list sa_timer;
+    atomic_t sa_due;
+    unsigned int sa_rate;
+
+    struct mutex tx_lock;  // held while draining the stream queues and while recovering the chip
+
+    /* Last value written to each SCI register, replayed after a reset */
+    u16 sci_shadow[16];
+    u16 sci_shadow_valid;
+
+    /* Decoder hang watchdog */
+    struct delayed_work wd_work;
+    unsigned long wd_starve_since;  // jiffies of the first DREQ timeout, 0 while data flows
+    unsigned long wd_last_write;
+    unsigned long tx_bytes;         // SDI bytes sent so far
+    unsigned long wd_dt_bytes;
+    unsigned long wd_dt_since;
+    unsigned long wd_dt_next;
+    u16 wd_dt;
+    struct vs10xx_wd_stats wd_stats;
+
+    /* Open streams and the one currently feeding the decoder (tx_lock) */
+    struct list_head streams;
+    int num_streams;
+    atomic_t num_writers;           // streams that have written, they share the pool
+    struct vs10xx_stream *cur_stream;
+    atomic_t tx_queued;             // elements queued over all streams
+    int switch_wait;
+    unsigned int stream_switches;
+    struct mutex vol_lock;          // user_vol, duck_atten and the SCI_VOL write made from them; taken after tx_lock
+    unsigned short user_vol;        // SCI_VOL as last set by VS10XX_SET_VOL or the knob, VS10XX_GET_VOL
+    unsigned int duck_atten;        // extra attenuation in 0.5 dB steps, faded out; changed under tx_lock too
+    unsigned long duck_next;
+
+    /* Detected chip; SPI never goes above the device tree rates (spi-max-frequency) */
+    const struct vs10xx_model *model;
+    int version;
+    u32 sci_dt_hz;
+    u32 sdi_dt_hz;
 };                            //   ۸ ٽ tx_pool_q  Ȱ
 
 extern struct vs10xx_chip vs10xx_chips[VS10XX_MAX_DEVICES];
 
+/* Both SPI devices bound; every node exists, but the overlay may wire fewer chips */
+static inline bool vs10xx_chip_probed(struct vs10xx_chip *chip) {
+    return READ_ONCE(chip->spi_ctrl) && READ_ONCE(chip->spi_data);
+}
+
 #endif /* __VS10XX_H__ */
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <linux/delay.h>
+#include <linux/ktime.h>
+#include <linux/sort.h>
+#include <linux/mm.h>
+#include "vs10xx.h"
+#include "vs10xx_iocomm.h"
+#include "vs10xx_device.h"
+#include "vs10xx_bench.h"
+
+/*
+ * Bus self-test. Streams end-fill bytes (zeros, which the decoder discards
+ * like the padding sent at the end of a file) through the normal SDI path,
+ * then times SCI_STATUS reads. Runs with tx_lock held and refuses to start
+ * while any stream still has data queued, so it never lands in the middle
+ * of real audio.
+ */
+
+static int vs10xx_bench_cmp(const void *a, const void *b) {
+    u32 x = *(const u32 *)a, y = *(const u32 *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void vs10xx_bench_pct(u32 *samples, int n, unsigned int *p50, unsigned int *p99) {
+    sort(samples, n, sizeof(u32), vs10xx_bench_cmp, NULL);
+    *p50 = samples[n / 2];
+    *p99 = samples[(n * 99) / 100];
+}
+
+static int vs10xx_bench_sdi(struct vs10xx_chip *chip, struct vs10xx_bench *b, u32 *samples) {
+    char fill[VS10XX_QUEUE_DATA_SIZE];
+    int i, n = b->sdi_bytes / VS10XX_QUEUE_DATA_SIZE;
+    ktime_t start, t0, wait;
+    u64 elapsed, low = 0;
+
+    memset(fill, 0, sizeof(fill));
+
+    start = ktime_get();
+    for (i = 0; i < n; i++) {
+        if (!gpiod_get_value(chip->gpio_dreq)) {
+            wait = ktime_get();
+            while (!gpiod_get_value(chip->gpio_dreq)) {
+                if (ktime_ms_delta(ktime_get(), wait) > VS10XX_BENCH_DREQ_MS) return -ETIMEDOUT;
+                usleep_range(50, 100);
+            }
+            low += ktime_to_ns(ktime_sub(ktime_get(), wait));
+        }
+
+        t0 = ktime_get();
+        if (vs10xx_io_data_tx(chip->id, fill, sizeof(fill)) < 0) return -EIO;
+        samples[i] = ktime_to_ns(ktime_sub(ktime_get(), t0));
+    }
+    elapsed = ktime_to_ns(ktime_sub(ktime_get(), start));
+    if (!elapsed) elapsed = 1;
+
+    b->sdi_bytes_per_sec = div64_u64((u64)n * VS10XX_QUEUE_DATA_SIZE * NSEC_PER_SEC, elapsed);
+    b->dreq_duty_permille = 1000 - div64_u64(low * 1000, elapsed);
+    vs10xx_bench_pct(samples, n, &b->sdi_p50_ns, &b->sdi_p99_ns);
+    return 0;
+}
+
+static int vs10xx_bench_sci(struct vs10xx_chip *chip, struct vs10xx_bench *b, u32 *samples) {
+    unsigned char cmd[] = {0x03, SCI_STATUS};
+    unsigned char res[2];
+    int i;
+    ktime_t t0;
+
+    for (i = 0; i < b->sci_reads; i++) {
+        // Only the transfer is timed, not the wait for the chip to be ready
+        if (!vs10xx_io_wtready(chip->id, 100)) return -ETIMEDOUT;
+
+        t0 = ktime_get();
+        if (vs10xx_io_ctrl_xf(chip->id, cmd, sizeof(cmd), res, sizeof(res)) < 0) return -EIO;
+        samples[i] = ktime_to_ns(ktime_sub(ktime_get(), t0));
+    }
+
+    vs10xx_bench_pct(samples, b->sci_reads, &b->sci_p50_ns, &b->sci_p99_ns);
+    return 0;
+}
+
+int vs10xx_bench_run(int id, struct vs10xx_bench *b) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+    u32 *samples;
+    int ret;
+
+    if (!b->sdi_bytes) b->sdi_bytes = VS10XX_BENCH_DEF_BYTES;
+    if (!b->sci_reads) b->sci_reads = VS10XX_BENCH_DEF_READS;
+    b->sdi_bytes = clamp_t(unsigned int, b->sdi_bytes, VS10XX_QUEUE_DATA_SIZE, VS10XX_BENCH_MAX_BYTES);
+    b->sdi_bytes -= b->sdi_bytes % VS10XX_QUEUE_DATA_SIZE;
+    b->sci_reads = min_t(unsigned int, b->sci_reads, VS10XX_BENCH_MAX_READS);
+
+    samples = kvmalloc_array(max_t(unsigned int, b->sdi_bytes / VS10XX_QUEUE_DATA_SIZE, b->sci_reads),
+                             sizeof(u32), GFP_KERNEL);
+    if (!samples) return -ENOMEM;
+
+    mutex_lock(&chip->tx_lock);
+    if (atomic_read(&chip->tx_queued)) {
+        ret = -EBUSY;
+    } else {
+        ret = vs10xx_bench_sdi(chip, b, samples);
+        if (!ret) ret = vs10xx_bench_sci(chip, b, samples);
+    }
+    mutex_unlock(&chip->tx_lock);
+
+    kvfree(samples);
+    return ret;
+}
\ No newline at end of file
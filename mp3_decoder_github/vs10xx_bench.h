@@ -0,0 +1,25 @@
+#ifndef __VS10XX_BENCH_H__
+#define __VS10XX_BENCH_H__
+
+#define VS10XX_BENCH_DEF_BYTES   (64 * 1024)
+#define VS10XX_BENCH_MAX_BYTES   (1024 * 1024)
+#define VS10XX_BENCH_DEF_READS   256
+#define VS10XX_BENCH_MAX_READS   4096
+#define VS10XX_BENCH_DREQ_MS     500   // give up if DREQ stays low this long
+
+/* VS10XX_BENCH request (first two fields) and result */
+struct vs10xx_bench {
+    unsigned int sdi_bytes;           // bytes to stream, 0 for the default
+    unsigned int sci_reads;           // SCI round trips, 0 for the default
+
+    unsigned int sdi_bytes_per_sec;   // including DREQ waits
+    unsigned int sdi_p50_ns;          // one 32-byte burst through vs10xx_io_data_tx()
+    unsigned int sdi_p99_ns;
+    unsigned int sci_p50_ns;          // one SCI_STATUS read through vs10xx_io_ctrl_xf()
+    unsigned int sci_p99_ns;
+    unsigned int dreq_duty_permille;  // share of the streaming time DREQ was high
+};
+
+int vs10xx_bench_run(int id, struct vs10xx_bench *b);
+
+#endif /* __VS10XX_BENCH_H__ */
\ No newline at end of file
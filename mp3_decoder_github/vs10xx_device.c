@@ -2,24 +2,69 @@
 #include "vs10xx_iocomm.h"
 #include "vs10xx_device.h"
 
-// SCI Registers
-#define SCI_MODE        0x00
-#define SCI_STATUS      0x01
-#define SCI_CLOCKF      0x03
-#define SCI_AUDATA      0x05
-#define SCI_VOL         0x0B
+// Registers replayed after a reset, in this order (clock first)
+static const unsigned char vs10xx_restore_regs[] = {
+    SCI_CLOCKF, SCI_MODE, SCI_BASS, SCI_AUDATA, SCI_VOL
+};
+
+/*
+ * spi-max-frequency in the device tree is what the board's wiring allows and
+ * is never exceeded. Until CLOCKF is written the chip runs from XTALI, so the
+ * links are also held below the XTALI limits; once the model's clock is in
+ * effect they may go up to what that model allows. Faster SPI therefore
+ * takes a higher spi-max-frequency, not a driver change.
+ */
+int vs10xx_device_set_speed(int id, int fast) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+    u32 sci_hz = min_t(u32, chip->sci_dt_hz, VS10XX_XTALI_SCI_HZ);
+    u32 sdi_hz = min_t(u32, chip->sdi_dt_hz, VS10XX_XTALI_SDI_HZ);
+    int status = 0;
+
+    if (fast) {
+        sci_hz = chip->model->sci_hz ? min(chip->model->sci_hz, chip->sci_dt_hz) : chip->sci_dt_hz;
+        sdi_hz = chip->model->sdi_hz ? min(chip->model->sdi_hz, chip->sdi_dt_hz) : chip->sdi_dt_hz;
+    }
+
+    mutex_lock(&chip->ctrl_lock);
+    if (chip->spi_ctrl->max_speed_hz != sci_hz) {
+        chip->spi_ctrl->max_speed_hz = sci_hz;
+        status = spi_setup(chip->spi_ctrl);
+    }
+    mutex_unlock(&chip->ctrl_lock);
+    if (status < 0) return status;
+
+    if (chip->spi_data->max_speed_hz != sdi_hz) {
+        chip->spi_data->max_speed_hz = sdi_hz;
+        status = spi_setup(chip->spi_data);
+    }
+    return status;
+}
 
 int vs10xx_device_init(int id) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
     unsigned char msb, lsb;
+    unsigned short clockf;
+
+    // The device tree rates, the ceiling for everything set_speed() picks
+    chip->sci_dt_hz = chip->spi_ctrl->max_speed_hz;
+    chip->sdi_dt_hz = chip->spi_data->max_speed_hz;
+    vs10xx_device_set_speed(id, 0);
     
     vs10xx_io_reset(id);
     
     // Read version
     vs10xx_device_r_sci_reg(id, SCI_STATUS, &msb, &lsb);
-    printk(KERN_INFO "vs10xx: VS10xx Version: %d\n", (lsb >> 4) & 0x0F);
+    chip->version = (lsb >> 4) & 0x0F;
+    chip->model = vs10xx_model_lookup(chip->version);
+    printk(KERN_INFO "vs10xx: VS10xx Version: %d (%s settings)\n", chip->version, chip->model->name);
     
-    // Set clock, e.g., XTALI * 4.5
-    vs10xx_device_w_sci_reg(id, SCI_CLOCKF, 0xB8, 0x00);
+    // Set clock, then SPI may run as fast as the new clock allows
+    clockf = chip->model->clockf;
+    vs10xx_device_w_sci_reg(id, SCI_CLOCKF, clockf >> 8, clockf & 0xFF);
+    if (vs10xx_device_set_speed(id, 1) < 0) {
+        PERR("id:%d could not raise SPI clock, staying at boot rates\n", id);
+        vs10xx_device_set_speed(id, 0);
+    }
     
     // Set volume
     vs10xx_device_w_sci_reg(id, SCI_VOL, 0xFE, 0xFE); // Min volume
@@ -40,6 +85,10 @@ int vs10xx_device_w_sci_reg(int id, unsigned char reg, unsigned char msb, unsign
     }
     
     status = vs10xx_io_ctrl_xf(id, cmd, sizeof(cmd), NULL, 0);
+    if (status == 0 && reg < 16) {
+        vs10xx_chips[id].sci_shadow[reg] = (msb << 8) | lsb;
+        vs10xx_chips[id].sci_shadow_valid |= 1 << reg;
+    }
     
     if (!vs10xx_io_wtready(id, 100)) {
         PERR("id:%d timeout after write (reg=%x)", id, reg);
@@ -69,4 +118,66 @@ int vs10xx_device_r_sci_reg(int id, unsigned char reg, unsigned char* msb, unsig
     }
 
     return status;
+}
+
+int vs10xx_device_r_wram(int id, unsigned short addr, unsigned short *buf, int n) {
+    int status;
+
+    status = vs10xx_device_w_sci_reg(id, SCI_WRAMADDR, addr >> 8, addr & 0xFF);
+    if (status < 0) return status;
+
+    // SCI_WRAM auto-increments the address, so all n words go out in one message
+    return vs10xx_io_ctrl_rd_burst(id, SCI_WRAM, buf, n);
+}
+
+int vs10xx_device_restore(int id) {
+    int i;
+    unsigned char reg;
+    unsigned short val;
+
+    for (i = 0; i < ARRAY_SIZE(vs10xx_restore_regs); i++) {
+        reg = vs10xx_restore_regs[i];
+        if (!(vs10xx_chips[id].sci_shadow_valid & (1 << reg))) continue;
+
+        val = vs10xx_chips[id].sci_shadow[reg];
+        if (reg == SCI_MODE) val &= ~SM_RESET;
+        if (vs10xx_device_w_sci_reg(id, reg, val >> 8, val & 0xFF) < 0) return -EIO;
+    }
+    return 0;
+}
+
+/*
+ * Brings a hung decoder back without reloading the module: SM_RESET first,
+ * xRESET if DREQ still does not come up, then the register shadow is
+ * replayed. Takes a few milliseconds in the normal case.
+ */
+int vs10xx_device_recover(int id) {
+    unsigned short mode = SM_SDINEW;
+    unsigned char cmd[4];
+
+    if (vs10xx_chips[id].sci_shadow_valid & (1 << SCI_MODE)) {
+        mode = vs10xx_chips[id].sci_shadow[SCI_MODE];
+    }
+    mode |= SM_RESET;
+
+    cmd[0] = 0x02;
+    cmd[1] = SCI_MODE;
+    cmd[2] = mode >> 8;
+    cmd[3] = mode & 0xFF;
+
+    // The reset drops the chip back to XTALI, so SPI has to slow down with it
+    vs10xx_device_set_speed(id, 0);
+
+    // DREQ may be the thing that is stuck, so SM_RESET goes out without waiting for it
+    vs10xx_io_ctrl_xf(id, cmd, sizeof(cmd), NULL, 0);
+    if (!vs10xx_io_wtready(id, 10)) {
+        vs10xx_io_reset(id);
+        if (!vs10xx_io_wtready(id, 100)) {
+            PERR("id:%d no DREQ after hardware reset\n", id);
+            return -EIO;
+        }
+    }
+
+    if (vs10xx_device_restore(id) < 0) return -EIO;
+    return vs10xx_device_set_speed(id, 1);
 }
\ No newline at end of file
@@ -1,8 +1,27 @@
 #ifndef __VS10XX_DEVICE_H__
 #define __VS10XX_DEVICE_H__
 
+// SCI Registers
+#define SCI_MODE        0x00
+#define SCI_STATUS      0x01
+#define SCI_BASS        0x02
+#define SCI_CLOCKF      0x03
+#define SCI_DECODE_TIME 0x04
+#define SCI_AUDATA      0x05
+#define SCI_WRAM        0x06
+#define SCI_WRAMADDR    0x07
+#define SCI_VOL         0x0B
+
+// SCI_MODE bits
+#define SM_RESET        0x0004
+#define SM_SDINEW       0x0800
+
 int vs10xx_device_init(int id);
+int vs10xx_device_set_speed(int id, int fast);
 int vs10xx_device_w_sci_reg(int id, unsigned char reg, unsigned char msb, unsigned char lsb);
 int vs10xx_device_r_sci_reg(int id, unsigned char reg, unsigned char* msb, unsigned char* lsb);
+int vs10xx_device_r_wram(int id, unsigned short addr, unsigned short *buf, int n);
+int vs10xx_device_restore(int id);
+int vs10xx_device_recover(int id);
 
 #endif /* __VS10XX_DEVICE_H__ */
\ No newline at end of file
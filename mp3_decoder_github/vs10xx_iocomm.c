@@ -39,14 +39,36 @@ int vs10xx_io_wtready(int id, int timeout) {
     return 1;
 }
 
+/*
+ * DREQ wait on the data path. With a fast SDI link a 1 ms sleep is longer
+ * than the decoder needs to drain 32 bytes, so models that set
+ * dreq_poll_us are polled at that interval instead.
+ */
+int vs10xx_io_data_wtready(int id) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+    unsigned int us = chip->model->dreq_poll_us;
+    unsigned long end;
+
+    if (!us) return vs10xx_io_wtready(id, 100);
+
+    end = jiffies + msecs_to_jiffies(100);
+    while (!gpiod_get_value(chip->gpio_dreq)) {
+        if (time_after(jiffies, end)) return 0;
+        usleep_range(us, 2 * us);
+    }
+    return 1;
+}
+
 int vs10xx_io_ctrl_xf(int id, const char *txbuf, unsigned txlen, char *rxbuf, unsigned rxlen) {
     int status = 0;
     struct spi_message *msg = &vs10xx_chips[id].msg;
     struct spi_transfer *xfer = vs10xx_chips[id].transfer;
 
+    mutex_lock(&vs10xx_chips[id].ctrl_lock);
     memset(xfer, 0, sizeof(vs10xx_chips[id].transfer));
     spi_message_init(msg);
 
+
     if (txbuf && txlen) {
         memcpy(vs10xx_chips[id].tx_buf, txbuf, txlen);
         xfer[0].tx_buf = vs10xx_chips[id].tx_buf;
@@ -62,6 +84,7 @@ int vs10xx_io_ctrl_xf(int id, const char *txbuf, unsigned txlen, char *rxbuf, un
     
     status = spi_sync(vs10xx_chips[id].spi_ctrl, msg);
     if (status < 0) {
+        mutex_unlock(&vs10xx_chips[id].ctrl_lock);
         pr_err("vs10xx: id:%d spi_sync failed: %d\n", id, status);
         return status;
     }
@@ -69,10 +92,57 @@ int vs10xx_io_ctrl_xf(int id, const char *txbuf, unsigned txlen, char *rxbuf, un
     if (rxbuf && rxlen) {
         memcpy(rxbuf, vs10xx_chips[id].rx_buf, rxlen);
     }
+    mutex_unlock(&vs10xx_chips[id].ctrl_lock);
     
     return status;
 }
 
+/*
+ * Reads the same SCI register n times in a single spi_message. Every read is
+ * its own [0x03, reg] + 2 byte transfer pair, with xCS toggled in between,
+ * so auto-incrementing registers such as SCI_WRAM can be drained with one
+ * spi_sync() instead of n.
+ */
+int vs10xx_io_ctrl_rd_burst(int id, unsigned char reg, unsigned short *vals, int n) {
+    int i, status;
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+    struct spi_message *msg = &chip->msg;
+    struct spi_transfer *xfer = chip->burst_xfer;
+
+    if (n <= 0 || n > VS10XX_SCI_BURST_MAX) return -EINVAL;
+
+    mutex_lock(&chip->ctrl_lock);
+    memset(xfer, 0, sizeof(struct spi_transfer) * 2 * n);
+    spi_message_init(msg);
+
+    chip->burst_cmd[0] = 0x03;
+    chip->burst_cmd[1] = reg;
+    for (i = 0; i < n; i++) {
+        xfer[2 * i].tx_buf = chip->burst_cmd;
+        xfer[2 * i].len = 2;
+        xfer[2 * i + 1].rx_buf = &chip->burst_rx[2 * i];
+        xfer[2 * i + 1].len = 2;
+        xfer[2 * i + 1].cs_change = (i != n - 1);
+        spi_message_add_tail(&xfer[2 * i], msg);
+        spi_message_add_tail(&xfer[2 * i + 1], msg);
+    }
+
+    status = spi_sync(chip->spi_ctrl, msg);
+    if (status < 0) {
+        mutex_unlock(&chip->ctrl_lock);
+        pr_err("vs10xx: id:%d burst spi_sync failed: %d\n", id, status);
+        return status;
+    }
+
+    for (i = 0; i < n; i++) {
+        vals[i] = (chip->burst_rx[2 * i] << 8) | chip->burst_rx[2 * i + 1];
+    }
+    mutex_unlock(&chip->ctrl_lock);
+
+    return status;
+}
+
+
 int vs10xx_io_data_tx(int id, const char *buf, int len) {
     struct spi_transfer t = {
         .tx_buf = buf,
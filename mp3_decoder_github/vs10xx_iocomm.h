@@ -6,6 +6,8 @@ void vs10xx_io_exit(int id);
 int vs10xx_io_reset(int id);
 int vs10xx_io_data_tx(int id, const char *buf, int len);
 int vs10xx_io_ctrl_xf(int id, const char *txbuf, unsigned txlen, char *rxbuf, unsigned rxlen);
+int vs10xx_io_ctrl_rd_burst(int id, unsigned char reg, unsigned short *vals, int n);
 int vs10xx_io_wtready(int id, int timeout);
+int vs10xx_io_data_wtready(int id);
 
 #endif /* __VS10XX_IOCOMM_H__ */
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <linux/input.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+#include "vs10xx.h"
+#include "vs10xx_stream.h"
+#include "vs10xx_knob.h"
+
+/*
+ * Optional in-kernel volume knob. An input handler attaches to the input
+ * device of the rotary encoder driver, matched by its bus and id so that
+ * other REL_DIAL devices (jog dials, some mice) are left alone, and turns
+ * detents into SCI_VOL writes without a round trip through user space. The
+ * encoder reports REL_DIAL already accelerated, so a fast turn covers the
+ * range in a few detents. The event callback runs with the input core's
+ * spinlock held, so it only accumulates the steps; the SCI write happens in a
+ * high priority work item that goes through the same path as VS10XX_SET_VOL,
+ * ducking included.
+ *
+ * Levels run from 0 (loudest) down. By default each level is knob_step
+ * half-dB quieter than the previous one and the last one mutes; knob_curve
+ * replaces that with an explicit attenuation per level.
+ */
+
+static bool knob_volume;
+module_param(knob_volume, bool, 0444);
+MODULE_PARM_DESC(knob_volume, "Let the rotary encoder drive the volume directly");
+
+static unsigned int knob_chip;
+module_param(knob_chip, uint, 0444);
+MODULE_PARM_DESC(knob_chip, "Decoder the knob controls");
+
+static unsigned int knob_step = VS10XX_KNOB_DEF_STEP;
+module_param(knob_step, uint, 0644);
+MODULE_PARM_DESC(knob_step, "Attenuation per detent in 0.5 dB units (linear curve)");
+
+static unsigned int knob_curve[VS10XX_KNOB_MAX_LEVELS];
+static unsigned int knob_curve_len;
+module_param_array(knob_curve, uint, &knob_curve_len, 0444);
+MODULE_PARM_DESC(knob_curve, "SCI_VOL attenuation per level, loudest first; overrides knob_step");
+
+static struct {
+    struct work_struct work;
+    atomic_t pending;           // detents not applied yet, clockwise positive
+    int level;
+    unsigned short applied;     // SCI_VOL as last written by the knob
+} knob;
+
+static int vs10xx_knob_levels(void) {
+    unsigned int step = clamp_val(READ_ONCE(knob_step), 1, VS10XX_KNOB_MUTE);
+
+    if (knob_curve_len) return knob_curve_len;
+    return DIV_ROUND_UP(VS10XX_KNOB_MUTE, step) + 1;
+}
+
+static unsigned int vs10xx_knob_atten(int level) {
+    unsigned int step = clamp_val(READ_ONCE(knob_step), 1, VS10XX_KNOB_MUTE);
+
+    if (knob_curve_len) return min_t(unsigned int, knob_curve[level], VS10XX_KNOB_MUTE);
+    return min_t(unsigned int, level * step, VS10XX_KNOB_MUTE);
+}
+
+/* The loudest level that is not louder than atten */
+static int vs10xx_knob_level_of(unsigned int atten) {
+    int levels = vs10xx_knob_levels();
+    int level;
+
+    for (level = 0; level < levels - 1; level++) {
+        if (vs10xx_knob_atten(level) >= atten) break;
+    }
+    return level;
+}
+
+static void vs10xx_knob_work(struct work_struct *work) {
+    struct vs10xx_chip *chip = &vs10xx_chips[knob_chip];
+    int delta = atomic_xchg(&knob.pending, 0);
+    unsigned short vol = READ_ONCE(chip->user_vol);
+    unsigned int atten;
+
+    if (!delta || !vs10xx_chip_probed(chip)) return;
+
+    // Pick up from wherever VS10XX_SET_VOL left the volume
+    if (knob.level < 0 || vol != knob.applied) knob.level = vs10xx_knob_level_of(vol >> 8);
+
+    knob.level = clamp(knob.level - delta, 0, vs10xx_knob_levels() - 1);
+    atten = vs10xx_knob_atten(knob.level);
+    knob.applied = (atten << 8) | atten;
+    // Takes vol_lock only, so a drain in progress does not hold the knob back
+    vs10xx_stream_set_volume(chip, knob.applied);
+}
+
+static void vs10xx_knob_event(struct input_handle *handle, unsigned int type, unsigned int code, int value) {
+    if (type != EV_REL || code != REL_DIAL || !value) return;
+
+    atomic_add(value, &knob.pending);
+    queue_work(system_highpri_wq, &knob.work);
+}
+
+static int vs10xx_knob_connect(struct input_handler *handler, struct input_dev *dev,
+                               const struct input_device_id *id) {
+    struct input_handle *handle;
+    int ret;
+
+    handle = kzalloc(sizeof(*handle), GFP_KERNEL);
+    if (!handle) return -ENOMEM;
+
+    handle->dev = dev;
+    handle->handler = handler;
+    handle->name = "vs10xx-knob";
+
+    ret = input_register_handle(handle);
+    if (ret) goto err_free;
+
+    ret = input_open_device(handle);
+    if (ret) goto err_unregister;
+
+    printk(KERN_INFO "vs10xx: knob bound to %s\n", dev->name);
+    return 0;
+
+err_unregister:
+    input_unregister_handle(handle);
+err_free:
+    kfree(handle);
+    return ret;
+}
+
+static void vs10xx_knob_disconnect(struct input_handle *handle) {
+    input_close_device(handle);
+    input_unregister_handle(handle);
+    kfree(handle);
+}
+
+static const struct input_device_id vs10xx_knob_ids[] = {
+    {
+        .flags = INPUT_DEVICE_ID_MATCH_BUS | INPUT_DEVICE_ID_MATCH_VENDOR | INPUT_DEVICE_ID_MATCH_PRODUCT |
+                 INPUT_DEVICE_ID_MATCH_EVBIT | INPUT_DEVICE_ID_MATCH_RELBIT,
+        .bustype = BUS_HOST,
+        .vendor = VS10XX_KNOB_VENDOR,
+        .product = VS10XX_KNOB_PRODUCT,
+        .evbit = { BIT_MASK(EV_REL) },
+        .relbit = { BIT_MASK(REL_DIAL) },
+    },
+    {}
+};
+
+static struct input_handler vs10xx_knob_handler = {
+    .event = vs10xx_knob_event,
+    .connect = vs10xx_knob_connect,
+    .disconnect = vs10xx_knob_disconnect,
+    .name = "vs10xx-knob",
+    .id_table = vs10xx_knob_ids,
+};
+
+int vs10xx_knob_init(void) {
+    int ret;
+
+    if (!knob_volume) return 0;
+
+    if (knob_chip >= VS10XX_MAX_DEVICES) {
+        PERR("knob_chip %u out of range\n", knob_chip);
+        knob_volume = false;
+        return -EINVAL;
+    }
+
+    INIT_WORK(&knob.work, vs10xx_knob_work);
+    atomic_set(&knob.pending, 0);
+    knob.level = -1;
+
+    ret = input_register_handler(&vs10xx_knob_handler);
+    if (ret) knob_volume = false;
+    return ret;
+}
+
+void vs10xx_knob_exit(void) {
+    if (!knob_volume) return;
+
+    input_unregister_handler(&vs10xx_knob_handler);
+    cancel_work_sync(&knob.work);
+}
\ No newline at end of file
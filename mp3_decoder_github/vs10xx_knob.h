@@ -0,0 +1,15 @@
+#ifndef __VS10XX_KNOB_H__
+#define __VS10XX_KNOB_H__
+
+#define VS10XX_KNOB_MAX_LEVELS  64
+#define VS10XX_KNOB_DEF_STEP    4     // 2 dB per detent (SCI_VOL is in 0.5 dB)
+#define VS10XX_KNOB_MUTE        0xFE
+
+/* Input id of the rotary encoder driver (ROTARY_INPUT_* in rotary_encoder.h) */
+#define VS10XX_KNOB_VENDOR      0x0001
+#define VS10XX_KNOB_PRODUCT     0x5245
+
+int vs10xx_knob_init(void);
+void vs10xx_knob_exit(void);
+
+#endif /* __VS10XX_KNOB_H__ */
\ No newline at end of file
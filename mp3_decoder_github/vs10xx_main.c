@@ -7,6 +7,11 @@
 #include "vs10xx_queue.h"
 #include "vs10xx_iocomm.h"
 #include "vs10xx_device.h"
+#include "vs10xx_spectrum.h"
+#include "vs10xx_watchdog.h"
+#include "vs10xx_bench.h"
+#include "vs10xx_knob.h"
+
 
 
 MODULE_LICENSE("GPL");
@@ -17,33 +22,120 @@ MODULE_DESCRIPTION("VS1003/VS1053 Audio Codec Driver");
 #define VS10XX_IOCTL_BASE 'v' //   ̹ ÿ ۵ϴµ       ̹  𸣱⶧ 浹    ȣ Ѵ.
 #define VS10XX_SET_VOL _IOW(VS10XX_IOCTL_BASE, 1, unsigned int) //   ɾ , ([ ȣ], [0:, 1:, 2: ׽Ʈ], [user_space Ŀη   Ÿ])
                                                                 //  α׷ ioctl(fd, VS10XX_SET_VOL, &volume_data) ȣϸ Ŀ VS10XX_SET_VOL  v ȣ  vs10xx̹  ų!    
+#define VS10XX_SET_SPECTRUM _IOW(VS10XX_IOCTL_BASE, 3, unsigned int)          // spectrum readout rate in Hz, 0 stops it
+#define VS10XX_GET_SPECTRUM _IOR(VS10XX_IOCTL_BASE, 4, struct vs10xx_spectrum) // latest band snapshot, never touches the SPI bus
+#define VS10XX_GET_WDSTATS _IOR(VS10XX_IOCTL_BASE, 5, struct vs10xx_wd_stats)   // decoder hang watchdog counters
+#define VS10XX_SET_STREAM _IOW(VS10XX_IOCTL_BASE, 6, struct vs10xx_stream_cfg)   // priority/ducking of this open file
+#define VS10XX_BENCH _IOWR(VS10XX_IOCTL_BASE, 7, struct vs10xx_bench)             // SPI throughput/latency self-test
+#define VS10XX_GET_INFO _IOR(VS10XX_IOCTL_BASE, 8, struct vs10xx_info)            // detected chip and SPI rates
+#define VS10XX_GET_VOL _IOR(VS10XX_IOCTL_BASE, 9, unsigned int)                   // volume applied by VS10XX_SET_VOL or the knob
 
 static dev_t vs10xx_dev_t;
 struct class *vs10xx_class;
 struct vs10xx_chip vs10xx_chips[VS10XX_MAX_DEVICES]; //vs10xx_chip vs10xx.h ǵǾִ Ĩ ϴµ ʿ   ִ ü
 
+/*
+ * Feeds the decoder from whichever stream the arbiter picks until all queues
+ * are empty or DREQ stays low. Any writer may end up sending another
+ * stream's data. Returns the number of elements sent.
+ */
+static int vs10xx_tx_drain(struct vs10xx_chip *chip) {
+    struct vs10xx_stream *st;
+    vs10xx_qel_t *qel;
+    int sent = 0;
+
+    mutex_lock(&chip->tx_lock);
+    while ((st = vs10xx_stream_pick(chip)) != NULL && (qel = vs10xx_queue_get_head(&st->q)) != NULL) {
+        // Ĩ ͸  غ   
+        if (!vs10xx_io_data_wtready(chip->id)) {
+            // غ ʾ,  ͸ ٽ ť  տ ְ 
+            vs10xx_queue_put_head(&st->q, qel);
+            if (!chip->wd_starve_since) chip->wd_starve_since = jiffies | 1;
+            break; 
+        }
+
+        //  
+        if (vs10xx_io_data_tx(chip->id, qel->data, qel->len) < 0) {
+            pr_err("vs10xx: Failed to send data via SPI\n");
+            //   ÿ ۴ Ǯ ݳ
+        }
+        chip->wd_starve_since = 0;
+        chip->tx_bytes += qel->len;
+        atomic_dec(&chip->tx_queued);
+        sent++;
+        
+        //  ۴ ٽ  Ǯ ݳ
+        vs10xx_queue_put_tail(&chip->tx_pool_q, qel);
+
+        // ۰ ٰ ٸ ٸ μ 
+        wake_up_interruptible(&chip->tx_wq);
+
+        // Spectrum readout, if one is due, goes out between two data bursts
+        vs10xx_spectrum_service(chip->id);
+        vs10xx_stream_duck_service(chip);
+    }
+    mutex_unlock(&chip->tx_lock);
+
+    return sent;
+}
+
 static int vs10xx_open(struct inode *inode, struct file *filp) {
     struct vs10xx_chip *chip = container_of(inode->i_cdev, struct vs10xx_chip, cdev);
-    filp->private_data = chip;
+    struct vs10xx_stream *st;
+
+    if (!vs10xx_chip_probed(chip)) return -ENODEV;
+
+    // Every open file gets its own stream, so two writers never interleave
+    st = vs10xx_stream_open(chip);
+    if (IS_ERR(st)) return PTR_ERR(st);
+
+    filp->private_data = st;
     PDEBUG("vs10xx_open\n");
     return 0;
 }
 
 static int vs10xx_release(struct inode *inode, struct file *filp) {
+    struct vs10xx_stream *st = filp->private_data;
+    struct vs10xx_chip *chip = st->chip;
+    unsigned long deadline = jiffies + msecs_to_jiffies(VS10XX_STREAM_CLOSE_MS);
+
+    // The tail of a "cat song.mp3 > /dev/vs10xx-0" is still queued; play it unless the stream was preempted
+    while (READ_ONCE(st->q.num_elements) && !READ_ONCE(st->preempted) && time_before(jiffies, deadline)) {
+        if (!vs10xx_tx_drain(chip) &&
+            wait_event_interruptible_timeout(chip->tx_wq, !READ_ONCE(st->q.num_elements),
+                                             msecs_to_jiffies(VS10XX_WD_PERIOD_MS)) < 0) {
+            break;
+        }
+    }
+
+    vs10xx_stream_release(st);
     PDEBUG("vs10xx_release\n");
     return 0;
 }
 
 static ssize_t vs10xx_write(struct file *filp, const char __user *buf, size_t count, loff_t *f_pos) {
-    struct vs10xx_chip *chip = filp->private_data;
+    struct vs10xx_stream *st = filp->private_data;
+    struct vs10xx_chip *chip = st->chip;
     size_t total_written = 0;
     vs10xx_qel_t *qel;   // 32byte ۿ ٸ 32byte յ Ϳ   ִ  ǵ vs10xx_qel_t 
 
+    if (!vs10xx_chip_probed(chip)) return -ENODEV;
+    vs10xx_stream_mark_writer(st);
+
     // ڰ û ͸ 32Ʈ ûũ  ó
     while (total_written < count) {
         // vs10xx_qel_t *qel;
         size_t chunk_size = min((size_t)VS10XX_QUEUE_DATA_SIZE, count - total_written);
 
+        // A stream may only hold its share of the pool; make room by playing
+        while (READ_ONCE(st->q.num_elements) >= vs10xx_stream_max_elements(chip)) {
+            if (!vs10xx_tx_drain(chip) &&
+                wait_event_interruptible_timeout(chip->tx_wq, st->q.num_elements < vs10xx_stream_max_elements(chip),
+                                                 msecs_to_jiffies(VS10XX_WD_PERIOD_MS)) < 0) {
+                return total_written ? total_written : -ERESTARTSYS;
+            }
+        }
+
         // 1.  Ǯ  ۸  ( )
         if (wait_event_interruptible(chip->tx_wq, (qel = vs10xx_queue_get_head(&chip->tx_pool_q)) != NULL)) {  // tx_pool_q   ۰ (32byte  2048   tx_data_q  ϋ) tx_wp 
             return -ERESTARTSYS;
@@ -55,51 +147,75 @@ static ssize_t vs10xx_write(struct file *filp, const char __user *buf, size_t co
             return -EFAULT;
         }
 
+        qel->len = chunk_size;
+
         // 3. Ͱ ä ۸  ť 
-        vs10xx_queue_put_tail(&chip->tx_data_q, qel);
+        vs10xx_queue_put_tail(&st->q, qel);
+        atomic_inc(&chip->tx_queued);
+        st->last_write = jiffies;
         total_written += chunk_size;
     }
 
     // 4.  ť ִ  ͸ ϵ  õ
-    while ((qel = vs10xx_queue_get_head(&chip->tx_data_q)) != NULL) {
-        // Ĩ ͸  غ   
-        if (!vs10xx_io_wtready(chip->id, 100)) {
-            // غ ʾ,  ͸ ٽ ť  տ ְ 
-            list_add(&qel->list, &chip->tx_data_q.head);
-            chip->tx_data_q.num_elements++;
-            break; 
-        }
+    vs10xx_tx_drain(chip);
 
-        //  
-        if (vs10xx_io_data_tx(chip->id, qel->data, VS10XX_QUEUE_DATA_SIZE) < 0) {
-            pr_err("vs10xx: Failed to send data via SPI\n");
-            //   ÿ ۴ Ǯ ݳ
-        }
-        
-        //  ۴ ٽ  Ǯ ݳ
-        vs10xx_queue_put_tail(&chip->tx_pool_q, qel);
-
-        // ۰ ٰ ٸ ٸ μ 
-        wake_up_interruptible(&chip->tx_wq);
-    }
+    vs10xx_wd_kick(chip->id);
 
     return total_written;
 }
 
 static long vs10xx_ioctl(struct file *filp, unsigned int cmd, unsigned long arg) {
-    struct vs10xx_chip *chip = filp->private_data;
+    struct vs10xx_stream *st = filp->private_data;
+    struct vs10xx_chip *chip = st->chip;
     int ret = 0;
     unsigned int vol;
+    unsigned int rate;
     unsigned char left, right;
+    struct vs10xx_spectrum sa;
+    struct vs10xx_wd_stats wd;
+    struct vs10xx_stream_cfg cfg;
+    struct vs10xx_bench bench;
+    struct vs10xx_info info;
 
     if (_IOC_TYPE(cmd) != VS10XX_IOCTL_BASE) return -ENOTTY;
+    if (!vs10xx_chip_probed(chip)) return -ENODEV;
     
     switch (cmd) {
         case VS10XX_SET_VOL:
             if (copy_from_user(&vol, (void __user *)arg, sizeof(vol))) return -EFAULT;
             left = (vol >> 8) & 0xFF;
             right = vol & 0xFF;
-            vs10xx_device_w_sci_reg(chip->id, 0x0B, left, right);
+            vs10xx_stream_set_volume(chip, (left << 8) | right);
+            break;
+        case VS10XX_GET_VOL:
+            vol = READ_ONCE(chip->user_vol);
+            if (copy_to_user((void __user *)arg, &vol, sizeof(vol))) return -EFAULT;
+            break;
+        case VS10XX_SET_SPECTRUM:
+            if (copy_from_user(&rate, (void __user *)arg, sizeof(rate))) return -EFAULT;
+            vs10xx_spectrum_set_rate(chip->id, rate);
+            break;
+        case VS10XX_GET_SPECTRUM:
+            vs10xx_spectrum_get(chip->id, &sa);
+            if (copy_to_user((void __user *)arg, &sa, sizeof(sa))) return -EFAULT;
+            break;
+        case VS10XX_GET_WDSTATS:
+            vs10xx_wd_get_stats(chip->id, &wd);
+            if (copy_to_user((void __user *)arg, &wd, sizeof(wd))) return -EFAULT;
+            break;
+        case VS10XX_SET_STREAM:
+            if (copy_from_user(&cfg, (void __user *)arg, sizeof(cfg))) return -EFAULT;
+            vs10xx_stream_configure(st, &cfg);
+            break;
+        case VS10XX_BENCH:
+            if (copy_from_user(&bench, (void __user *)arg, sizeof(bench))) return -EFAULT;
+            ret = vs10xx_bench_run(chip->id, &bench);
+            if (ret) return ret;
+            if (copy_to_user((void __user *)arg, &bench, sizeof(bench))) return -EFAULT;
+            break;
+        case VS10XX_GET_INFO:
+            vs10xx_model_get_info(chip->id, &info);
+            if (copy_to_user((void __user *)arg, &info, sizeof(info))) return -EFAULT;
             break;
         default:
             return -ENOTTY;
@@ -216,15 +332,24 @@ static int __init vs10xx_init(void) {
         }
 
         vs10xx_queue_init(&vs10xx_chips[i].tx_pool_q);
-        INIT_LIST_HEAD(&vs10xx_chips[i].tx_data_q.head);
-        vs10xx_chips[i].tx_data_q.num_elements = 0;
-        spin_lock_init(&vs10xx_chips[i].tx_data_q.lock);
+        INIT_LIST_HEAD(&vs10xx_chips[i].streams);
+        atomic_set(&vs10xx_chips[i].tx_queued, 0);
+        atomic_set(&vs10xx_chips[i].num_writers, 0);
+        vs10xx_chips[i].user_vol = 0xFEFE;
+        vs10xx_chips[i].model = vs10xx_model_lookup(-1);
         
         init_waitqueue_head(&vs10xx_chips[i].tx_wq);
+        mutex_init(&vs10xx_chips[i].ctrl_lock);
+        mutex_init(&vs10xx_chips[i].tx_lock);
+        mutex_init(&vs10xx_chips[i].vol_lock);
+        vs10xx_spectrum_init(i);
+        vs10xx_wd_init(i);
     }
 
     spi_register_driver(&vs10xx_spi_ctrl);
     spi_register_driver(&vs10xx_spi_data);
+
+    if (vs10xx_knob_init()) PERR("Failed to bind the volume knob\n");
     
     printk(KERN_INFO "vs10xx: Driver loaded\n");
     return 0;
@@ -232,12 +357,15 @@ static int __init vs10xx_init(void) {
 
 static void __exit vs10xx_exit(void) {
     int i;
+    vs10xx_knob_exit();
     spi_unregister_driver(&vs10xx_spi_ctrl);
     spi_unregister_driver(&vs10xx_spi_data);
     
     for (i = 0; i < VS10XX_MAX_DEVICES; i++) {
         device_destroy(vs10xx_class, MKDEV(MAJOR(vs10xx_dev_t), i));
         cdev_del(&vs10xx_chips[i].cdev);
+        vs10xx_spectrum_exit(i);
+        vs10xx_wd_exit(i);
         vs10xx_queue_free(&vs10xx_chips[i].tx_pool_q);
         vs10xx_io_exit(i);
     }
@@ -0,0 +1,49 @@
+#include "vs10xx.h"
+#include "vs10xx_model.h"
+
+/*
+ * SPI limits follow from CLKI: SCI reads at CLKI/7, SCI writes and SDI at
+ * CLKI/4. With a 12.288 MHz crystal and 0x8800 (3.5x + 1.0x) the VS1053
+ * runs at 43 MHz, so 5 MHz SCI and 10 MHz SDI stay clear of both. The
+ * VS1003 keeps the settings this driver always used.
+ */
+static const struct vs10xx_model vs10xx_models[] = {
+    {
+        .version = VS10XX_VER_VS1003,
+        .name = "VS1003",
+        .clockf = 0xB800,
+        .sa_wram = VS10XX_SA_WRAM_BASE,
+        .codecs = VS10XX_CODEC_MP3 | VS10XX_CODEC_WMA | VS10XX_CODEC_MIDI | VS10XX_CODEC_WAV,
+    },
+    {
+        .version = VS10XX_VER_VS1053,
+        .name = "VS1053",
+        .clockf = 0x8800,
+        .sci_hz = 5000000,
+        .sdi_hz = 10000000,
+        .dreq_poll_us = 100,
+        .sa_wram = VS10XX_SA_WRAM_BASE,
+        .codecs = VS10XX_CODEC_MP3 | VS10XX_CODEC_WMA | VS10XX_CODEC_MIDI | VS10XX_CODEC_WAV |
+                  VS10XX_CODEC_AAC | VS10XX_CODEC_OGG,
+    },
+};
+
+const struct vs10xx_model *vs10xx_model_lookup(int version) {
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(vs10xx_models); i++) {
+        if (vs10xx_models[i].version == version) return &vs10xx_models[i];
+    }
+    return &vs10xx_models[0];
+}
+
+void vs10xx_model_get_info(int id, struct vs10xx_info *out) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+
+    memset(out, 0, sizeof(*out));
+    out->version = chip->version;
+    strscpy(out->name, chip->model->name, sizeof(out->name));
+    out->codecs = chip->model->codecs;
+    if (chip->spi_ctrl) out->sci_hz = chip->spi_ctrl->max_speed_hz;
+    if (chip->spi_data) out->sdi_hz = chip->spi_data->max_speed_hz;
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef __VS10XX_MODEL_H__
+#define __VS10XX_MODEL_H__
+
+// SS_VER field of SCI_STATUS
+#define VS10XX_VER_VS1003   3
+#define VS10XX_VER_VS1053   4
+
+// Formats the decoder can play without a plugin (vs10xx_info.codecs)
+#define VS10XX_CODEC_MP3    (1 << 0)
+#define VS10XX_CODEC_WMA    (1 << 1)
+#define VS10XX_CODEC_MIDI   (1 << 2)
+#define VS10XX_CODEC_WAV    (1 << 3)
+#define VS10XX_CODEC_AAC    (1 << 4)
+#define VS10XX_CODEC_OGG    (1 << 5)
+
+// Before CLOCKF the chip runs from a 12.288 MHz XTALI: SCI reads at CLKI/7, SDI at CLKI/4
+#define VS10XX_XTALI_SCI_HZ 1750000
+#define VS10XX_XTALI_SDI_HZ 3000000
+
+/*
+ * What differs between the chips this driver handles. The entry is picked
+ * from the version in SCI_STATUS; anything unknown is run with the VS1003
+ * entry, which only uses the SPI rates from the device tree. The model rates
+ * are upper bounds; spi-max-frequency still caps them.
+ */
+struct vs10xx_model {
+    int version;
+    const char *name;
+    unsigned short clockf;      // SCI_CLOCKF written at init
+    unsigned int sci_hz;        // SPI limits once clockf is in effect, 0 for no limit beyond the device tree
+    unsigned int sdi_hz;
+    unsigned int dreq_poll_us;  // DREQ poll interval on the data path, 0 for the 1 ms sleep
+    unsigned short sa_wram;     // spectrum analyzer plugin base, 0 if there is none
+    unsigned int codecs;
+};
+
+/* Detected chip and current SPI rates (VS10XX_GET_INFO) */
+struct vs10xx_info {
+    unsigned int version;
+    char name[16];
+    unsigned int codecs;        // VS10XX_CODEC_*
+    unsigned int sci_hz;
+    unsigned int sdi_hz;
+};
+
+const struct vs10xx_model *vs10xx_model_lookup(int version);
+void vs10xx_model_get_info(int id, struct vs10xx_info *out);
+
+#endif /* __VS10XX_MODEL_H__ */
\ No newline at end of file
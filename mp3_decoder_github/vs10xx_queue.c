@@ -52,4 +52,55 @@ void vs10xx_queue_put_tail(vs10xx_queue_t *q, vs10xx_qel_t *el) {
     list_add_tail(&el->list, &q->head);
     q->num_elements++;
     spin_unlock_irqrestore(&q->lock, flags);
+}
+
+void vs10xx_queue_put_head(vs10xx_queue_t *q, vs10xx_qel_t *el) {
+    unsigned long flags;
+    spin_lock_irqsave(&q->lock, flags);
+    list_add(&el->list, &q->head);
+    q->num_elements++;
+    spin_unlock_irqrestore(&q->lock, flags);
+}
+
+/* Offset of the first MPEG audio frame sync (11 set bits) in el, or -1 */
+int vs10xx_qel_find_sync(const vs10xx_qel_t *el) {
+    int i;
+    for (i = 0; i + 1 < el->len; i++) {
+        if ((unsigned char)el->data[i] == 0xFF && ((unsigned char)el->data[i + 1] & 0xE0) == 0xE0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Drops everything in q up to the next frame sync and hands the emptied
+ * elements back to pool. Returns the number of bytes dropped.
+ */
+int vs10xx_queue_trim_to_sync(vs10xx_queue_t *q, vs10xx_queue_t *pool) {
+    unsigned long flags;
+    vs10xx_qel_t *el, *tmp;
+    LIST_HEAD(drop);
+    int pos, dropped = 0;
+
+    spin_lock_irqsave(&q->lock, flags);
+    list_for_each_entry_safe(el, tmp, &q->head, list) {
+        pos = vs10xx_qel_find_sync(el);
+        if (pos >= 0) {
+            memmove(el->data, el->data + pos, el->len - pos);
+            el->len -= pos;
+            dropped += pos;
+            break;
+        }
+        dropped += el->len;
+        list_move_tail(&el->list, &drop);
+        q->num_elements--;
+    }
+    spin_unlock_irqrestore(&q->lock, flags);
+
+    list_for_each_entry_safe(el, tmp, &drop, list) {
+        list_del(&el->list);
+        vs10xx_queue_put_tail(pool, el);
+    }
+    return dropped;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 typedef struct vs10xx_qel {
     struct list_head list;
+    int len;
     char data[VS10XX_QUEUE_DATA_SIZE];
 } vs10xx_qel_t;
 
@@ -21,5 +22,8 @@ int vs10xx_queue_init(vs10xx_queue_t *q);
 void vs10xx_queue_free(vs10xx_queue_t *q);
 vs10xx_qel_t* vs10xx_queue_get_head(vs10xx_queue_t *q);
 void vs10xx_queue_put_tail(vs10xx_queue_t *q, vs10xx_qel_t *el);
+void vs10xx_queue_put_head(vs10xx_queue_t *q, vs10xx_qel_t *el);
+int vs10xx_qel_find_sync(const vs10xx_qel_t *el);
+int vs10xx_queue_trim_to_sync(vs10xx_queue_t *q, vs10xx_queue_t *pool);
 
 #endif /* __VS10XX_QUEUE_H__ */
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include <linux/jiffies.h>
+#include "vs10xx.h"
+#include "vs10xx_device.h"
+#include "vs10xx_spectrum.h"
+
+/*
+ * The timer only marks a readout as due. The SCI traffic itself is issued by
+ * the transmit path between two SDI bursts (vs10xx_spectrum_service()), so it
+ * never competes with data for DREQ, and readers only ever see the published
+ * snapshot through the seqlock.
+ */
+static void vs10xx_spectrum_timer_cb(struct timer_list *t) {
+    struct vs10xx_chip *chip = from_timer(chip, t, sa_timer);
+    unsigned int rate = READ_ONCE(chip->sa_rate);
+
+    if (!rate) return;
+
+    atomic_set(&chip->sa_due, 1);
+    mod_timer(&chip->sa_timer, jiffies + msecs_to_jiffies(1000 / rate));
+}
+
+void vs10xx_spectrum_init(int id) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+
+    seqlock_init(&chip->sa_lock);
+    memset(&chip->sa, 0, sizeof(chip->sa));
+    chip->sa_rate = 0;
+    atomic_set(&chip->sa_due, 0);
+    timer_setup(&chip->sa_timer, vs10xx_spectrum_timer_cb, 0);
+}
+
+void vs10xx_spectrum_exit(int id) {
+    WRITE_ONCE(vs10xx_chips[id].sa_rate, 0);
+    del_timer_sync(&vs10xx_chips[id].sa_timer);
+}
+
+void vs10xx_spectrum_set_rate(int id, unsigned int hz) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+
+    if (hz > VS10XX_SA_MAX_RATE) hz = VS10XX_SA_MAX_RATE;
+
+    WRITE_ONCE(chip->sa_rate, hz);
+    if (hz) {
+        mod_timer(&chip->sa_timer, jiffies + 1);
+    } else {
+        del_timer_sync(&chip->sa_timer);
+        atomic_set(&chip->sa_due, 0);
+    }
+}
+
+void vs10xx_spectrum_service(int id) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+    unsigned short words[VS10XX_SA_HDR_WORDS + VS10XX_SA_MAX_BANDS];
+    unsigned int nbands;
+    int i, n;
+
+    if (!atomic_xchg(&chip->sa_due, 0)) return;
+    if (!chip->model->sa_wram) return;
+
+    // Read as many bands as last time; the first readout takes them all
+    n = chip->sa.nbands ? chip->sa.nbands : VS10XX_SA_MAX_BANDS;
+    if (vs10xx_device_r_wram(id, chip->model->sa_wram, words, VS10XX_SA_HDR_WORDS + n) < 0) return;
+
+    nbands = words[0];
+    if (!nbands || nbands > VS10XX_SA_MAX_BANDS) return; // plugin not loaded
+    if (nbands > n) nbands = n;
+
+    write_seqlock(&chip->sa_lock);
+    chip->sa.seq++;
+    chip->sa.nbands = nbands;
+    for (i = 0; i < nbands; i++) {
+        chip->sa.bands[i] = words[VS10XX_SA_HDR_WORDS + i] & VS10XX_SA_LEVEL_MASK;
+    }
+    write_sequnlock(&chip->sa_lock);
+}
+
+void vs10xx_spectrum_get(int id, struct vs10xx_spectrum *out) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+    unsigned int seq;
+
+    do {
+        seq = read_seqbegin(&chip->sa_lock);
+        *out = chip->sa;
+    } while (read_seqretry(&chip->sa_lock, seq));
+}
\ No newline at end of file
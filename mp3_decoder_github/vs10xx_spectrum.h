@@ -0,0 +1,30 @@
+#ifndef __VS10XX_SPECTRUM_H__
+#define __VS10XX_SPECTRUM_H__
+
+/*
+ * Spectrum analyzer plugin layout in X memory. The plugin keeps its band
+ * count at VS10XX_SA_WRAM_BASE and the band values right after a reserved
+ * word, so one SCI_WRAMADDR write followed by a burst of SCI_WRAM reads
+ * returns both. Band values use the 6 LSBs.
+ */
+#define VS10XX_SA_WRAM_BASE   0x1802
+#define VS10XX_SA_HDR_WORDS   2
+#define VS10XX_SA_LEVEL_MASK  0x3F
+
+#define VS10XX_SA_MAX_BANDS   32
+#define VS10XX_SA_MAX_RATE    30   // Hz
+
+/* Snapshot handed to user space by VS10XX_GET_SPECTRUM */
+struct vs10xx_spectrum {
+    unsigned int seq;       // incremented on every new readout
+    unsigned int nbands;    // 0 until the plugin has answered
+    unsigned char bands[VS10XX_SA_MAX_BANDS];
+};
+
+void vs10xx_spectrum_init(int id);
+void vs10xx_spectrum_exit(int id);
+void vs10xx_spectrum_set_rate(int id, unsigned int hz);
+void vs10xx_spectrum_service(int id);
+void vs10xx_spectrum_get(int id, struct vs10xx_spectrum *out);
+
+#endif /* __VS10XX_SPECTRUM_H__ */
\ No newline at end of file
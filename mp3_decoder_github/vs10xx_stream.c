@@ -0,0 +1,198 @@
+#include <linux/jiffies.h>
+#include "vs10xx.h"
+#include "vs10xx_iocomm.h"
+#include "vs10xx_device.h"
+#include "vs10xx_stream.h"
+
+/*
+ * Stream arbitration. Every open file owns a queue; the transmit path asks
+ * vs10xx_stream_pick() which one to feed next, under tx_lock. The decoder can
+ * only follow one bitstream, so a switch is made at an MPEG frame boundary of
+ * the outgoing stream and the resumed stream restarts at its next frame sync.
+ */
+
+struct vs10xx_stream *vs10xx_stream_open(struct vs10xx_chip *chip) {
+    struct vs10xx_stream *st;
+
+    st = kzalloc(sizeof(*st), GFP_KERNEL);
+    if (!st) return ERR_PTR(-ENOMEM);
+
+    st->chip = chip;
+    INIT_LIST_HEAD(&st->q.head);
+    st->q.num_elements = 0;
+    spin_lock_init(&st->q.lock);
+
+    mutex_lock(&chip->tx_lock);
+    if (chip->num_streams >= VS10XX_MAX_STREAMS) {
+        mutex_unlock(&chip->tx_lock);
+        kfree(st);
+        return ERR_PTR(-EBUSY);
+    }
+    list_add_tail(&st->node, &chip->streams);
+    chip->num_streams++;
+    mutex_unlock(&chip->tx_lock);
+
+    return st;
+}
+
+void vs10xx_stream_release(struct vs10xx_stream *st) {
+    struct vs10xx_chip *chip = st->chip;
+    vs10xx_qel_t *qel;
+
+    mutex_lock(&chip->tx_lock);
+    list_del(&st->node);
+    chip->num_streams--;
+    if (st->writer) atomic_dec(&chip->num_writers);
+    if (chip->cur_stream == st) chip->cur_stream = NULL;
+
+    // Whatever was not played yet goes back to the pool
+    while ((qel = vs10xx_queue_get_head(&st->q)) != NULL) {
+        atomic_dec(&chip->tx_queued);
+        vs10xx_queue_put_tail(&chip->tx_pool_q, qel);
+    }
+    mutex_unlock(&chip->tx_lock);
+
+    wake_up_interruptible(&chip->tx_wq);
+    kfree(st);
+}
+
+/*
+ * Elements one stream may hold. The pool is shared evenly between the
+ * streams that have written, so files only opened for ioctls take no share
+ * and a lone writer can buffer as much as it did before streams existed.
+ */
+unsigned int vs10xx_stream_max_elements(struct vs10xx_chip *chip) {
+    return VS10XX_QUEUE_MAX_ELEMENTS / max(atomic_read(&chip->num_writers), 1);
+}
+
+/* Called by write() before queueing; the stream counts as a writer until it is closed */
+void vs10xx_stream_mark_writer(struct vs10xx_stream *st) {
+    // Two threads may write to the same file at once
+    if (xchg(&st->writer, 1)) return;
+    atomic_inc(&st->chip->num_writers);
+}
+
+void vs10xx_stream_configure(struct vs10xx_stream *st, const struct vs10xx_stream_cfg *cfg) {
+    mutex_lock(&st->chip->tx_lock);
+    st->cfg = *cfg;
+    mutex_unlock(&st->chip->tx_lock);
+}
+
+/* Called with vol_lock held, so two SCI_VOL writes never go out in the wrong order */
+static void vs10xx_stream_apply_vol(struct vs10xx_chip *chip) {
+    unsigned short vol = READ_ONCE(chip->user_vol);
+    unsigned int left = (vol >> 8) + chip->duck_atten;
+    unsigned int right = (vol & 0xFF) + chip->duck_atten;
+
+    if (left > 0xFE) left = 0xFE;
+    if (right > 0xFE) right = 0xFE;
+    vs10xx_device_w_sci_reg(chip->id, SCI_VOL, left, right);
+}
+
+/*
+ * Not under tx_lock: a drain holds that for a whole write, paced by DREQ,
+ * while a volume change only has to wait for the SCI write in progress.
+ */
+void vs10xx_stream_set_volume(struct vs10xx_chip *chip, unsigned short vol) {
+    mutex_lock(&chip->vol_lock);
+    WRITE_ONCE(chip->user_vol, vol);
+    vs10xx_stream_apply_vol(chip);
+    mutex_unlock(&chip->vol_lock);
+}
+
+/* The arbiter and the fade change the ducking under tx_lock, this applies it */
+static void vs10xx_stream_set_duck(struct vs10xx_chip *chip, unsigned int atten) {
+    mutex_lock(&chip->vol_lock);
+    chip->duck_atten = atten;
+    vs10xx_stream_apply_vol(chip);
+    mutex_unlock(&chip->vol_lock);
+}
+
+/* Fades a ducked stream back to the user volume, one step per call at most */
+void vs10xx_stream_duck_service(struct vs10xx_chip *chip) {
+    if (!chip->duck_atten || time_before(jiffies, chip->duck_next)) return;
+
+    chip->duck_next = jiffies + msecs_to_jiffies(VS10XX_DUCK_STEP_MS);
+    vs10xx_stream_set_duck(chip, chip->duck_atten > VS10XX_DUCK_STEP ? chip->duck_atten - VS10XX_DUCK_STEP : 0);
+}
+
+/*
+ * Returns 1 when cur may be left now. If a frame starts inside its head
+ * element, the bytes in front of it are sent first so the switch happens
+ * exactly on the sync.
+ */
+static int vs10xx_stream_at_boundary(struct vs10xx_chip *chip, struct vs10xx_stream *cur) {
+    vs10xx_qel_t *qel;
+    int pos;
+
+    if (++chip->switch_wait > VS10XX_STREAM_SWITCH_MAX) return 1;
+
+    qel = vs10xx_queue_get_head(&cur->q);
+    if (!qel) return 1;
+
+    pos = vs10xx_qel_find_sync(qel);
+    if (pos > 0 && vs10xx_io_wtready(chip->id, 100)) {
+        vs10xx_io_data_tx(chip->id, qel->data, pos);
+        chip->tx_bytes += pos;
+        memmove(qel->data, qel->data + pos, qel->len - pos);
+        qel->len -= pos;
+        pos = 0;
+    }
+    vs10xx_queue_put_head(&cur->q, qel);
+
+    return pos == 0;
+}
+
+static void vs10xx_stream_switch(struct vs10xx_chip *chip, struct vs10xx_stream *next) {
+    struct vs10xx_stream *prev = chip->cur_stream;
+    int before;
+
+    chip->switch_wait = 0;
+    chip->cur_stream = next;
+    chip->stream_switches++;
+
+    if (prev && prev->cfg.priority < next->cfg.priority) {
+        // Preempted; its queue stays put until it wins again
+        prev->preempted = 1;
+        if (chip->duck_atten) vs10xx_stream_set_duck(chip, 0);
+    }
+
+    if (next->preempted) {
+        next->preempted = 0;
+        before = next->q.num_elements;
+        vs10xx_queue_trim_to_sync(&next->q, &chip->tx_pool_q);
+        atomic_sub(before - next->q.num_elements, &chip->tx_queued);
+
+        if (prev && prev->cfg.duck_db) {
+            chip->duck_next = jiffies + msecs_to_jiffies(VS10XX_DUCK_STEP_MS);
+            vs10xx_stream_set_duck(chip, prev->cfg.duck_db * 2);
+        }
+    }
+}
+
+/* Called with tx_lock held; NULL when nothing is queued */
+struct vs10xx_stream *vs10xx_stream_pick(struct vs10xx_chip *chip) {
+    struct vs10xx_stream *st, *best = NULL, *cur = chip->cur_stream;
+
+    list_for_each_entry(st, &chip->streams, node) {
+        if (!READ_ONCE(st->q.num_elements)) continue;
+        if (!best || st->cfg.priority > best->cfg.priority ||
+            (st->cfg.priority == best->cfg.priority && st == cur)) {
+            best = st;
+        }
+    }
+
+    if (!best || best == cur) return best;
+
+    // The playing stream is only between two writes; keep equal or lower ones off the decoder
+    if (cur && !cur->q.num_elements && best->cfg.priority <= cur->cfg.priority &&
+        time_before(jiffies, cur->last_write + msecs_to_jiffies(VS10XX_STREAM_HOLD_MS))) {
+        return NULL;
+    }
+
+    // Let the current stream reach the end of its frame first
+    if (cur && cur->q.num_elements && !vs10xx_stream_at_boundary(chip, cur)) return cur;
+
+    vs10xx_stream_switch(chip, best);
+    return best->q.num_elements ? best : vs10xx_stream_pick(chip);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef __VS10XX_STREAM_H__
+#define __VS10XX_STREAM_H__
+
+#include <linux/list.h>
+#include "vs10xx_queue.h"
+
+#define VS10XX_MAX_STREAMS          8
+#define VS10XX_STREAM_SWITCH_MAX    64   // elements to wait for a frame sync before switching anyway
+#define VS10XX_STREAM_HOLD_MS       300  // the playing stream keeps the decoder this long between writes
+#define VS10XX_STREAM_CLOSE_MS      5000 // close() waits at most this long for queued data to play
+
+#define VS10XX_DUCK_STEP            2    // 1 dB per step (SCI_VOL is in 0.5 dB)
+#define VS10XX_DUCK_STEP_MS         50
+
+/* Per-open-file settings (VS10XX_SET_STREAM) */
+struct vs10xx_stream_cfg {
+    int priority;           // higher preempts lower, default 0
+    unsigned int duck_db;   // when this stream ends, the resumed one fades in from -duck_db
+};
+
+struct vs10xx_chip;
+
+/* One per open file; written data is queued here until the arbiter picks it */
+struct vs10xx_stream {
+    struct list_head node;
+    struct vs10xx_chip *chip;
+    vs10xx_queue_t q;
+    struct vs10xx_stream_cfg cfg;
+    int preempted;          // interrupted by a higher priority stream
+    int writer;             // has written, counts in vs10xx_stream_max_elements()
+    unsigned long last_write;
+};
+
+struct vs10xx_stream *vs10xx_stream_open(struct vs10xx_chip *chip);
+void vs10xx_stream_release(struct vs10xx_stream *st);
+unsigned int vs10xx_stream_max_elements(struct vs10xx_chip *chip);
+void vs10xx_stream_mark_writer(struct vs10xx_stream *st);
+void vs10xx_stream_configure(struct vs10xx_stream *st, const struct vs10xx_stream_cfg *cfg);
+struct vs10xx_stream *vs10xx_stream_pick(struct vs10xx_chip *chip);
+void vs10xx_stream_set_volume(struct vs10xx_chip *chip, unsigned short vol);
+void vs10xx_stream_duck_service(struct vs10xx_chip *chip);
+
+#endif /* __VS10XX_STREAM_H__ */
\ No newline at end of file
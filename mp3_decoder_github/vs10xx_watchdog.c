@@ -0,0 +1,131 @@
+#include <linux/jiffies.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
+#include "vs10xx.h"
+#include "vs10xx_device.h"
+#include "vs10xx_watchdog.h"
+
+/*
+ * Decoder hang watchdog. The transmit path records when DREQ first failed to
+ * come up (wd_starve_since) and how many bytes went out (tx_bytes); this work
+ * polls those while a stream is active and also samples SCI_DECODE_TIME once
+ * a second. Either symptom lasting past its threshold triggers an in-place
+ * recovery.
+ */
+
+static int vs10xx_wd_decode_stalled(struct vs10xx_chip *chip) {
+    unsigned char msb, lsb;
+    unsigned short dt;
+    unsigned long bytes = READ_ONCE(chip->tx_bytes);
+    int ret;
+
+    // Don't put an SCI read in the middle of a drain; try again next tick
+    if (!mutex_trylock(&chip->tx_lock)) return 0;
+    ret = vs10xx_device_r_sci_reg(chip->id, SCI_DECODE_TIME, &msb, &lsb);
+    mutex_unlock(&chip->tx_lock);
+    if (ret < 0) return 0;
+
+    chip->wd_dt_next = jiffies + HZ;
+
+    dt = (msb << 8) | lsb;
+    if (dt != chip->wd_dt || bytes == chip->wd_dt_bytes) {
+        // Decoding, or simply nothing was sent (paused): start over
+        chip->wd_dt = dt;
+        chip->wd_dt_bytes = bytes;
+        chip->wd_dt_since = jiffies;
+        return 0;
+    }
+
+    return time_after(jiffies, chip->wd_dt_since + msecs_to_jiffies(VS10XX_WD_STALL_MS));
+}
+
+static void vs10xx_wd_recover(struct vs10xx_chip *chip) {
+    ktime_t start = ktime_get();
+    int dropped = 0;
+    int before, ret;
+    struct vs10xx_stream *st;
+
+    mutex_lock(&chip->tx_lock);
+    // A volume change during the reset would be lost, or replayed from a stale shadow
+    mutex_lock(&chip->vol_lock);
+    ret = vs10xx_device_recover(chip->id);
+    mutex_unlock(&chip->vol_lock);
+    if (ret < 0) {
+        chip->wd_stats.failures++;
+        mutex_unlock(&chip->tx_lock);
+        PERR("id:%d decoder recovery failed\n", chip->id);
+        return;
+    }
+
+    // Resume from the next frame boundary instead of mid-frame
+    st = chip->cur_stream;
+    if (st) {
+        before = st->q.num_elements;
+        dropped = vs10xx_queue_trim_to_sync(&st->q, &chip->tx_pool_q);
+        atomic_sub(before - st->q.num_elements, &chip->tx_queued);
+    }
+
+    chip->wd_starve_since = 0;
+    chip->wd_dt = 0;
+    chip->wd_dt_bytes = READ_ONCE(chip->tx_bytes);
+    chip->wd_dt_since = jiffies;
+
+    chip->wd_stats.recoveries++;
+    chip->wd_stats.dropped_bytes += dropped;
+    chip->wd_stats.last_recovery_us = ktime_us_delta(ktime_get(), start);
+    mutex_unlock(&chip->tx_lock);
+
+    // Elements may have gone back to the pool
+    wake_up_interruptible(&chip->tx_wq);
+
+    pr_warn("vs10xx: id:%d decoder recovered in %u us (#%u, %d bytes skipped)\n",
+            chip->id, chip->wd_stats.last_recovery_us, chip->wd_stats.recoveries, dropped);
+}
+
+static void vs10xx_wd_work(struct work_struct *work) {
+    struct vs10xx_chip *chip = container_of(to_delayed_work(work), struct vs10xx_chip, wd_work);
+    unsigned long since = READ_ONCE(chip->wd_starve_since);
+    int queued = atomic_read(&chip->tx_queued);
+
+    // Never bound: there is no decoder to recover, and no SPI device to do it with
+    if (!vs10xx_chip_probed(chip)) return;
+
+    if (since && queued && time_after(jiffies, since + msecs_to_jiffies(VS10XX_WD_STARVE_MS))) {
+        chip->wd_stats.starvations++;
+        vs10xx_wd_recover(chip);
+    } else if (time_after_eq(jiffies, chip->wd_dt_next) && vs10xx_wd_decode_stalled(chip)) {
+        chip->wd_stats.stalls++;
+        vs10xx_wd_recover(chip);
+    }
+
+    if (atomic_read(&chip->tx_queued) ||
+        time_before(jiffies, READ_ONCE(chip->wd_last_write) + msecs_to_jiffies(VS10XX_WD_IDLE_MS))) {
+        schedule_delayed_work(&chip->wd_work, msecs_to_jiffies(VS10XX_WD_PERIOD_MS));
+    }
+}
+
+void vs10xx_wd_init(int id) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+
+    INIT_DELAYED_WORK(&chip->wd_work, vs10xx_wd_work);
+    chip->wd_starve_since = 0;
+    chip->wd_dt_next = jiffies;
+    memset(&chip->wd_stats, 0, sizeof(chip->wd_stats));
+}
+
+void vs10xx_wd_exit(int id) {
+    cancel_delayed_work_sync(&vs10xx_chips[id].wd_work);
+}
+
+/* Called by write(); keeps the watchdog polling while a stream is active */
+void vs10xx_wd_kick(int id) {
+    struct vs10xx_chip *chip = &vs10xx_chips[id];
+
+    if (!vs10xx_chip_probed(chip)) return;
+    WRITE_ONCE(chip->wd_last_write, jiffies);
+    schedule_delayed_work(&chip->wd_work, msecs_to_jiffies(VS10XX_WD_PERIOD_MS));
+}
+
+void vs10xx_wd_get_stats(int id, struct vs10xx_wd_stats *out) {
+    *out = vs10xx_chips[id].wd_stats;
+}
\ No newline at end of file
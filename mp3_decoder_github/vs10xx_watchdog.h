@@ -0,0 +1,24 @@
+#ifndef __VS10XX_WATCHDOG_H__
+#define __VS10XX_WATCHDOG_H__
+
+#define VS10XX_WD_PERIOD_MS   100   // polling period while data is flowing
+#define VS10XX_WD_STARVE_MS   250   // DREQ low this long with data queued
+#define VS10XX_WD_STALL_MS    3000  // SCI_DECODE_TIME frozen this long while data is sent
+#define VS10XX_WD_IDLE_MS     2000  // stop polling this long after the last write
+
+/* Counters handed to user space by VS10XX_GET_WDSTATS */
+struct vs10xx_wd_stats {
+    unsigned int recoveries;        // successful in-place recoveries
+    unsigned int starvations;       // triggered by DREQ starvation
+    unsigned int stalls;            // triggered by decode time stagnation
+    unsigned int failures;          // recoveries that left the chip dead
+    unsigned int last_recovery_us;  // duration of the last recovery
+    unsigned int dropped_bytes;     // skipped to reach a frame boundary
+};
+
+void vs10xx_wd_init(int id);
+void vs10xx_wd_exit(int id);
+void vs10xx_wd_kick(int id);
+void vs10xx_wd_get_stats(int id, struct vs10xx_wd_stats *out);
+
+#endif /* __VS10XX_WATCHDOG_H__ */
\ No newline at end of file
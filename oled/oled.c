@@ -4,33 +4,361 @@
 #include <linux/cdev.h>
 #include <linux/device.h>
 #include <linux/i2c.h>
+#include <linux/of.h>
+#include <linux/of_device.h>
 #include <linux/random.h>
 #include <linux/slab.h>     // kmalloc, kfree  ߰
 #include <linux/delay.h>
+#include <linux/workqueue.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+#include <linux/fb.h>
+#include <linux/mm.h>
+#include <linux/ioctl.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/firmware.h>
+#include <linux/kref.h>
 #include "oled.h"
+#include "oled_draw.h"
 
-// --- I2C  ȭ  ---
-#define I2C_BUS_NUMBER  1   // ϴ I2C  ȣ (: Raspberry Pi 1)
-#define OLED_I2C_ADDR   0x3C  // OLED I2C ּ
-#define SCREEN_WIDTH    128
-#define SCREEN_HEIGHT   64
-#define SCREEN_PAGES    (SCREEN_HEIGHT / 8)
+#define CREATE_TRACE_POINTS
+#include "oled_trace.h"
+
+// --- ȭ  (г   struct oled_geometry) ---
+#define OLED_MAX_PANELS 4
+#define OLED_MAX_PAGES  8     // 64 rows
+#define OLED_WINDOW_COST 6  // address command bytes sent per flush window
+#define OLED_CMD_MAX    32  // commands per oled_send_cmds() call
+// Worst case flush: every page its own window, plus the control bytes and scroll commands
+#define OLED_XFER_SIZE  (SCREEN_WIDTH * OLED_MAX_PAGES + OLED_MAX_PAGES * (OLED_WINDOW_COST + 2) + 16)
+
+// Hardware-scrolled title (marquee), used when the title is wider than the panel
+#define OLED_MARQUEE_GAP      24    // blank columns between the end of the title and its start
+#define OLED_MARQUEE_MAX      (OLED_TITLE_MAX * 6 + OLED_MARQUEE_GAP)
+#define OLED_SCROLL_INTERVAL  0x07  // 0x26/0x27 interval code for 2 frames per column
+#define OLED_SCROLL_STEP_MS   20    // 2 frames at the ~100 Hz frame rate set by 0xD5 0x80
+#define OLED_MARQUEE_RESYNC   128   // columns scrolled between two full rewrites, bounds the drift against jiffies
+
+// Text
+#define OLED_RUN_CACHE        8     // rendered text runs kept per panel
+#define OLED_GLYPH_MAX_W      11    // widest atlas glyph; a title of wide glyphs can outgrow the marquee and is cut
+#define OLED_GLYPH_MAGIC      "OLG1"
 
 // --- ̹  ---
 #define DRIVER_NAME "oled"
 #define DEVICE_NAME "oled"
 #define CLASS_NAME  "oled_class"
 
+/*
+ * A complete frame: the pixels in page layout and the title strip that
+ * scrolls on the marquee page.
+ */
+struct oled_frame {
+    unsigned char pix[SCREEN_WIDTH * OLED_MAX_PAGES];
+    unsigned char marquee[OLED_MARQUEE_MAX];
+    int marquee_len;           // 0 while the title fits and is drawn normally
+    unsigned int marquee_gen;  // bumped for every new strip, restarts the scroll
+    unsigned int seq;          // commit number
+};
+
+// UI widgets; bit n of a dirty mask means the inputs of widget n may have changed
+enum {
+    OLED_W_SPEAKER,
+    OLED_W_VOLUME,
+    OLED_W_CLOCK,
+    OLED_W_TRACK,
+    OLED_W_PROGRESS,
+    OLED_W_SPECTRUM,
+    OLED_W_TITLE,
+    OLED_W_PLAYTIME,
+    OLED_W_TOTAL,
+    OLED_W_COUNT
+};
+#define OLED_DIRTY_ALL     ((1 << OLED_W_COUNT) - 1)
+#define OLED_DIRTY_REDRAW  (1 << OLED_W_COUNT)   // the back buffer is not ours, draw everything from scratch
+
+// Widget kinds; a layout leaves the widgets it has no room for at OLED_WK_NONE
+enum {
+    OLED_WK_NONE,
+    OLED_WK_TEXT,
+    OLED_WK_BARS,
+    OLED_WK_ICON,
+    OLED_WK_PROGRESS,
+};
+
+// Text widget flags
+#define OLED_ALIGN_CENTER   0x01
+#define OLED_ALIGN_MARQUEE  0x02   // too wide for the box: hardware scroll on the marquee page
+
+struct oled_box {
+    int x, y, w, h;
+};
+
+/*
+ * One element of the retained UI: where it sits, how it is drawn and what
+ * it shows now. Setting an input that equals the cached state does
+ * nothing; otherwise the widget is marked dirty and the next render clears
+ * and redraws its box only.
+ */
+struct oled_widget {
+    unsigned char kind;        // OLED_WK_*
+    struct oled_box box;
+    unsigned char dx, dy;      // content offset inside the box
+    unsigned char flags;       // text: OLED_ALIGN_*
+    unsigned char bars, bar_w, bar_pitch;  // bars: count, width, distance; they grow up from the box bottom
+    const unsigned char *icon; // icon: box.w columns in page layout
+
+    bool dirty;
+    char text[OLED_TITLE_MAX];
+    unsigned char level[OLED_SPECTRUM_BANDS];
+    unsigned int value, max;
+};
+
+// Everything the UI shows; the title may be longer than mp3_ui_data.song_title
+struct oled_ui_state {
+    struct mp3_ui_data ui;
+    char title[OLED_TITLE_MAX];
+};
+
+// Argument of any OLED_SET_* ioctl
+union oled_field {
+    unsigned char volume;
+    char time[6];
+    struct oled_track track;
+    char title[OLED_TITLE_MAX];
+    int run_stop;
+    unsigned char levels[OLED_SPECTRUM_BANDS];
+};
+
+/*
+ * Numbers behind /sys/kernel/debug/oled/<panel>/stats, for tuning max_fps
+ * and spectrum_fps against the I2C bus. Render time covers drawing into the
+ * back buffer, I2C time the i2c_transfer() of a flush.
+ */
+struct oled_stats {
+    u64 render_ns_last, render_ns_max, render_ns_total;
+    u64 i2c_ns_last, i2c_ns_max, i2c_ns_total;
+    u64 bytes_total;
+    unsigned int bytes_last, bytes_max;
+    unsigned int flushes;              // successful transfers, marquee columns and resyncs included
+    unsigned int flush_errors;
+    unsigned int chunks;               // i2c_transfer() calls the flushes were split into
+    unsigned int throttled;            // flushes put off by bus_budget
+    unsigned int frames_sent;          // commits that reached the panel
+    unsigned int frames_dropped;       // commits replaced by a newer one before they were sent
+    unsigned int fps;                  // frames_sent in the last full second
+    unsigned int fps_count;
+    unsigned long fps_since;
+    unsigned long loaded;
+};
+
+/*
+ * Glyph atlas firmware (glyph_firmware, /lib/firmware/oled-glyphs.bin) for
+ * everything font5x7 does not cover, Hangul in particular: this header and
+ * count records sorted by code point. A glyph is up to OLED_GLYPH_MAX_W
+ * columns of 8 pixels in page layout, LSB on top, like font5x7. All fields
+ * are little endian and cols past width are zero. A bad magic or count, a
+ * width out of range or a code point out of order refuses the whole file.
+ * user_space/music_vol_ctrl/oled_glyphs.c builds one from a BDF font.
+ */
+struct oled_glyph_hdr {
+    char magic[4];             // OLED_GLYPH_MAGIC
+    __le32 count;
+} __packed;
+
+struct oled_glyph {
+    __le32 cp;                 // Unicode code point
+    u8 width;                  // 1..OLED_GLYPH_MAX_W
+    u8 cols[OLED_GLYPH_MAX_W];
+} __packed;
+
+/*
+ * A string rendered at y & 7 == shift: cols[i] is column i already shifted,
+ * the low byte goes to the page of y, the high byte to the page below.
+ * Only runs that fit on the panel are kept.
+ */
+struct oled_text_run {
+    char text[OLED_TITLE_MAX];
+    unsigned char shift;
+    unsigned short width;
+    unsigned int used;         // LRU stamp, 0 = empty
+    u16 cols[SCREEN_WIDTH];
+};
+
+struct oled_panel;
+
+/*
+ * What differs between the supported controllers and panel sizes. flush
+ * is the transfer path specialised for the geometry at compile time, see
+ * __oled_flush().
+ */
+struct oled_geometry {
+    const char *name;
+    int height, pages;
+    int col_offset;            // RAM column shown at the left edge (SH1106: 132 column RAM)
+    unsigned char com_pins;    // 0xDA argument
+    bool page_mode;            // SH1106: no 0x20/0x21/0x22, one page per window
+    bool hw_scroll;            // SSD1306 0x26/0x27 horizontal scroll
+    int marquee_page;          // page the title strip scrolls on
+    const struct oled_widget *layout;
+    void (*flush)(struct oled_panel *p);
+};
+
+/*
+ * One panel bound from the device tree. Everything that used to be a global
+ * lives here, so every panel renders and flushes on its own workers.
+ */
+struct oled_panel {
+    int id;
+    struct kref ref;                   // probe and every open file; the last put frees the panel
+    bool removing;                     // set under lock and pending_lock, nothing is (re)scheduled after
+    struct i2c_client *client;
+    const struct oled_geometry *geo;
+    struct cdev *cdev;                 // own allocation, open files may hold it past the panel
+    struct device *dev;
+
+    /*
+     * Double buffering: frames are drawn into back under lock and committed
+     * by swapping it with front under frame_lock. The flush worker copies
+     * front into out under the same spinlock and sends that, so the next
+     * frame is drawn while the last one is still on the bus and the panel
+     * never gets a half drawn frame.
+     */
+    struct oled_frame frames[2];
+    struct oled_frame *back;
+    struct oled_frame *front;
+    struct oled_frame out;
+    unsigned int out_seq;              // seq of the frame the last successful flush sent
+    unsigned int front_pages;          // pages drawn since the flush worker last copied the front frame
+    unsigned int out_pages;            // those pages for the flush in progress
+    spinlock_t frame_lock;
+    struct delayed_work flush_work;
+
+    // Flush worker only: what the panel currently shows; flushes only send the difference
+    unsigned char shadow[SCREEN_WIDTH * OLED_MAX_PAGES];
+    bool shadow_valid;
+    unsigned int stale_pages;          // pages whose panel content is unknown (after a scroll)
+
+    /*
+     * The title strip is rendered once and the panel scrolls it by itself.
+     * The panel only rotates its 128 columns, so once per scroll step the
+     * flush worker streams the strip in at the wrap point: a one column
+     * window rewrites panel column 0, the column about to wrap around to the
+     * right edge, with the strip column that belongs there. The scroll only
+     * moves the marquee page, so windows on the other pages are sent while
+     * it runs. The column the panel has reached is estimated from the time
+     * since the scroll was started; the scroll is stopped and the whole page
+     * rewritten only for a new strip, after a missed step and every
+     * OLED_MARQUEE_RESYNC columns, so the estimate cannot drift.
+     */
+    int marquee_origin;                // strip column at panel column 0 when the scroll started
+    unsigned int marquee_gen;          // strip the origin belongs to
+    unsigned long marquee_since;
+    int marquee_fed;                   // scroll steps whose wrap column has been written
+    bool scrolling;                    // hardware scroll is active
+
+    // kmalloc memory so the I2C adapter may DMA from it
+    unsigned char *xfer_buf;
+    unsigned char *cmd_buf;
+
+    // Bus clock from the adapter's firmware node; bus_tokens is the bus time (ns) a flush may still use
+    u32 bus_hz;
+    s64 bus_tokens;
+    u64 bus_refill;
+
+    struct oled_widget widgets[OLED_W_COUNT];
+
+    // Rendered strings, under lock like the back buffer
+    struct oled_text_run runs[OLED_RUN_CACHE];
+    unsigned int run_clock;
+    unsigned int run_hits, run_misses;
+
+    // Frame waiting for the renderer (render_work) and the widgets it changes
+    struct oled_ui_state next;
+    unsigned int next_dirty;
+    spinlock_t pending_lock;
+    struct mutex lock;                 // back and the renderers drawing into it
+    struct delayed_work render_work;
+    unsigned long last_render;
+    unsigned int frames_rendered;
+    unsigned int frames_coalesced;
+
+    struct oled_stats stats;
+    spinlock_t stats_lock;
+    struct dentry *debugfs;
+
+    unsigned char bar_height[OLED_SPECTRUM_BANDS];
+    bool spectrum_running;             // spectrum_run_stop == 0 in the last rendered frame
+    struct hrtimer spectrum_timer;
+    struct work_struct spectrum_work;
+
+    // /dev/fbN view of the panel; while user space has it open, mp3_ui_data frames wait
+    struct fb_info *fb_info;
+    struct fb_deferred_io fb_defio;
+    atomic_t fb_users;
+};
+
 // ---   ---
 static dev_t dev_num;
 static struct class *mp3_class;
-static struct cdev mp3_cdev;
-static struct i2c_client *oled_client;
+static struct oled_panel *oled_panels[OLED_MAX_PANELS];
+static DEFINE_SPINLOCK(oled_panels_lock);
+static struct dentry *oled_debugfs;
+
+static unsigned int max_fps = 10;
+module_param(max_fps, uint, 0644);
+MODULE_PARM_DESC(max_fps, "Maximum display refresh rate, 0 for no limit (default 10)");
+
+static int spectrum_fps_set(const char *val, const struct kernel_param *kp);
+static const struct kernel_param_ops spectrum_fps_ops = {
+    .set = spectrum_fps_set,
+    .get = param_get_uint,
+};
+static unsigned int spectrum_fps = 30;
+module_param_cb(spectrum_fps, &spectrum_fps_ops, &spectrum_fps, 0644);
+MODULE_PARM_DESC(spectrum_fps, "Spectrum bar animation rate once levels are supplied, 0 to redraw only on updates (default 30)");
 
-// OLED ȭ   
-static unsigned char oled_buffer[SCREEN_WIDTH * SCREEN_PAGES];
+static unsigned int bus_budget = 500;
+module_param(bus_budget, uint, 0644);
+MODULE_PARM_DESC(bus_budget, "I2C bus time per second a panel may use for flushes, in permille, 0 for no limit (default 500)");
+
+static char *glyph_firmware = "oled-glyphs.bin";
+module_param(glyph_firmware, charp, 0444);
+MODULE_PARM_DESC(glyph_firmware, "Glyph atlas for characters outside ASCII, loaded by the first panel, empty for none (default oled-glyphs.bin)");
+
+static unsigned int flush_chunk = 256;
+module_param(flush_chunk, uint, 0644);
+MODULE_PARM_DESC(flush_chunk, "Bytes per i2c_transfer() of a flush, other devices on the bus may run in between; 0 for a single transfer (default 256)");
+
+/*
+ * Spectrum levels come from a shared page (mmap of /dev/oled, the
+ * OLED_SET_SPECTRUM_LEVELS ioctl or oled_spectrum_update()), one for all
+ * panels. The producer just stores the bytes and bumps seq; an hrtimer per
+ * panel redraws the bars at spectrum_fps, letting them fall back one pixel
+ * per frame, and only the spectrum pages are sent. There must be a single
+ * producer: seq + 1 is a plain read and write, and the mmap user bumps the
+ * same counter, so two producers lose increments and mix their levels.
+ */
+static struct oled_levels *oled_levels;
+
+// Loaded once by the first probe and read-only afterwards
+static const struct firmware *oled_glyph_fw;
+static const struct oled_glyph *oled_glyphs;
+static unsigned int oled_nglyphs;
+static bool oled_glyph_tried;
+static DEFINE_MUTEX(oled_glyph_lock);
+
+/*
+ * Digit fast path: "MM:SS" and "NN/NN" change every second but only use
+ * these characters, so they are drawn straight from columns shifted for
+ * every y & 7 once at load, without decoding or a cache lookup.
+ */
+static const char oled_digit_chars[] = "0123456789:/";
+static u16 oled_digit_cols[8][sizeof(oled_digit_chars) - 1][6];
 
-extern const unsigned char font5x7[];
 static const unsigned char icon_speaker[] = {
     0x18, 0x3C, 0x3C, 0x7E, 0xC3, 0xFF, 0xFF
 };
@@ -39,338 +367,1727 @@ static const unsigned char icon_speaker[] = {
 // == OLED  Լ (ϵ  κ) - ϼ  ==
 // ===================================================================
 
-// I2C ɾ 
-static int oled_send_cmd(unsigned char cmd) {
-    char buf[2] = {0x00, cmd}; // Control byte 0x00 ɾ ǹ
+// ɾ   0x00 Ʈ Ʈ ϳ ڿ  
+static int oled_send_cmds(struct oled_panel *p, const unsigned char *cmds, int n) {
     int ret;
-    if (!oled_client) return -ENODEV;
-    
-    ret = i2c_master_send(oled_client, buf, 2);
+    if (n > OLED_CMD_MAX) return -EINVAL;
+
+    p->cmd_buf[0] = 0x00; // Control byte 0x00 ɾ ǹ
+    memcpy(&p->cmd_buf[1], cmds, n);
+    ret = i2c_master_send(p->client, p->cmd_buf, n + 1);
     if (ret < 0) {
-        printk(KERN_ERR "[OLED] i2c_master_send (CMD) failed: %d\n", ret);
+        dev_err_ratelimited(&p->client->dev, "i2c_master_send (CMD) failed: %d\n", ret);
     }
     return ret;
 }
 
-// ȭ ۸ OLED  (ȿ  )
-static void oled_flush_buffer(void) {
-    // 1024Ʈ ȭ  + 1Ʈ Ʈ Ʈ
-    unsigned char *transfer_buf;
-    int ret;
+// I2C ɾ 
+static int oled_send_cmd(struct oled_panel *p, unsigned char cmd) {
+    return oled_send_cmds(p, &cmd, 1);
+}
 
-    if (!oled_client) return;
+// Changed column range of every page; hi < lo means the page is unchanged.
+// Only pages in out_pages can differ from the shadow.
+static __always_inline int oled_find_dirty(struct oled_panel *p, int *lo, int *hi, const int pages) {
+    int page, col, dirty = 0;
+    unsigned char *now, *was;
 
-    transfer_buf = kmalloc(sizeof(oled_buffer) + 1, GFP_KERNEL);
-    if (!transfer_buf) {
-        printk(KERN_ERR "[OLED] Failed to allocate memory for flush buffer\n");
-        return;
+    for (page = 0; page < pages; page++) {
+        lo[page] = 0;
+        hi[page] = -1;
+        if (!p->shadow_valid || (p->stale_pages & (1 << page))) {
+            hi[page] = SCREEN_WIDTH - 1;
+            dirty++;
+            continue;
+        }
+        if (!(p->out_pages & (1 << page))) continue;
+
+        now = &p->out.pix[page * SCREEN_WIDTH];
+        was = &p->shadow[page * SCREEN_WIDTH];
+        for (col = 0; col < SCREEN_WIDTH && now[col] == was[col]; col++);
+        if (col == SCREEN_WIDTH) continue;
+        lo[page] = col;
+        for (col = SCREEN_WIDTH - 1; now[col] == was[col]; col--);
+        hi[page] = col;
+        dirty++;
     }
-    
-    transfer_buf[0] = 0x40; // ù Ʈ   ǹϴ Ʈ Ʈ
-    memcpy(&transfer_buf[1], oled_buffer, sizeof(oled_buffer));
+    return dirty;
+}
+
+/*
+ * Adds one column/page window to the flush: an address command message and
+ * a data message, both pointing into xfer_buf at *pos. In page mode
+ * (SH1106) a window is a single page addressed with 0xB0/0x0X/0x1X.
+ */
+static __always_inline void oled_add_window(struct oled_panel *p, struct i2c_msg *msgs, int *nmsgs, int *pos,
+                                            int c0, int c1, int p0, int p1, const bool page_mode, const int col_offset) {
+    unsigned char *cmd = &p->xfer_buf[*pos];
+    unsigned char *data;
+    int page, width = c1 - c0 + 1, ncmd;
 
     // ȭ Ʈ  ּ  ɾ
-    oled_send_cmd(0x21); // Set Column Address
-    oled_send_cmd(0);    // Start
-    oled_send_cmd(127);  // End
-    oled_send_cmd(0x22); // Set Page Address
-    oled_send_cmd(0);    // Start
-    oled_send_cmd(7);    // End
-
-    // غ ۸ I2C  ѹ 
-    ret = i2c_master_send(oled_client, transfer_buf, sizeof(oled_buffer) + 1);
-    if (ret < 0) {
-        printk(KERN_ERR "[OLED] Failed to flush buffer to screen: %d\n", ret);
+    cmd[0] = 0x00;
+    if (page_mode) {
+        cmd[1] = 0xB0 | p0;                            // Set Page Start Address
+        cmd[2] = 0x00 | ((c0 + col_offset) & 0x0F);    // Set Lower Column Start Address
+        cmd[3] = 0x10 | ((c0 + col_offset) >> 4);      // Set Higher Column Start Address
+        ncmd = 3;
     } else {
-        printk(KERN_INFO "[OLED] Buffer flushed to screen (%d bytes).\n", ret);
+        cmd[1] = 0x21; // Set Column Address
+        cmd[2] = c0;   // Start
+        cmd[3] = c1;   // End
+        cmd[4] = 0x22; // Set Page Address
+        cmd[5] = p0;   // Start
+        cmd[6] = p1;   // End
+        ncmd = OLED_WINDOW_COST;
+    }
+
+    data = cmd + ncmd + 1;
+    data[0] = 0x40; // ù Ʈ   ǹϴ Ʈ Ʈ
+    for (page = p0; page <= p1; page++) {
+        memcpy(&data[1 + (page - p0) * width], &p->out.pix[page * SCREEN_WIDTH + c0], width);
+    }
+
+    msgs[*nmsgs].addr = p->client->addr;
+    msgs[*nmsgs].flags = 0;
+    msgs[*nmsgs].len = ncmd + 1;
+    msgs[*nmsgs].buf = cmd;
+    msgs[*nmsgs + 1].addr = p->client->addr;
+    msgs[*nmsgs + 1].flags = 0;
+    msgs[*nmsgs + 1].len = width * (p1 - p0 + 1) + 1;
+    msgs[*nmsgs + 1].buf = data;
+
+    *nmsgs += 2;
+    *pos += ncmd + 1 + msgs[*nmsgs - 1].len;
+}
+
+// Adds a command message (0x00 control byte + cmds) to the flush
+static void oled_add_cmds(struct oled_panel *p, struct i2c_msg *msgs, int *nmsgs, int *pos, const unsigned char *cmds, int n) {
+    unsigned char *buf = &p->xfer_buf[*pos];
+
+    buf[0] = 0x00;
+    memcpy(&buf[1], cmds, n);
+    msgs[*nmsgs].addr = p->client->addr;
+    msgs[*nmsgs].flags = 0;
+    msgs[*nmsgs].len = n + 1;
+    msgs[*nmsgs].buf = buf;
+    *nmsgs += 1;
+    *pos += n + 1;
+}
+
+/*
+ * Puts the part of the title strip the panel should be showing now into out
+ * and returns the strip column it starts at. The marquee state is left
+ * alone: the caller commits it once the page has reached the panel.
+ */
+static int oled_marquee_sync(struct oled_panel *p) {
+    unsigned char *row = &p->out.pix[p->geo->marquee_page * SCREEN_WIDTH];
+    int col, pos = p->marquee_origin;
+
+    if (p->marquee_gen != p->out.marquee_gen) {
+        pos = 0;
+    } else if (p->scrolling) {
+        pos += jiffies_to_msecs(jiffies - p->marquee_since) / OLED_SCROLL_STEP_MS;
+    }
+    pos %= p->out.marquee_len;
+    for (col = 0; col < SCREEN_WIDTH; col++) {
+        row[col] = p->out.marquee[(pos + col) % p->out.marquee_len];
+    }
+    return pos;
+}
+
+// Columns the panel has scrolled since the scroll was started
+static int oled_marquee_steps(struct oled_panel *p) {
+    return jiffies_to_msecs(jiffies - p->marquee_since) / OLED_SCROLL_STEP_MS;
+}
+
+// Jiffies until the next wrap column is due, halfway through the step before it wraps; 0 if it is due now
+static unsigned long oled_marquee_wait(struct oled_panel *p) {
+    unsigned long due = p->marquee_since +
+                        msecs_to_jiffies(p->marquee_fed * OLED_SCROLL_STEP_MS + OLED_SCROLL_STEP_MS / 2);
+
+    return time_after(due, jiffies) ? due - jiffies : 0;
+}
+
+/*
+ * Bus time budget, a token bucket in nanoseconds of bus time: every second
+ * of wall time credits bus_budget permille of a second, at most one
+ * second's worth is saved up, and every flush is charged the time its
+ * transfers actually took. A flush that does not fit waits, so a burst of
+ * frames cannot keep the bus away from the other devices on it.
+ */
+
+// Estimated bus time of bytes in nmsgs messages: 9 clocks per byte, plus the address byte of each message
+static u64 oled_bus_ns(struct oled_panel *p, int bytes, int nmsgs) {
+    return div_u64((u64)(bytes + nmsgs) * 9 * NSEC_PER_SEC, p->bus_hz);
+}
+
+// 0 if a flush of cost ns may start now, otherwise the jiffies until enough bus time is credited
+static unsigned long oled_bus_admit(struct oled_panel *p, u64 cost) {
+    unsigned int budget = READ_ONCE(bus_budget);
+    u64 now = ktime_get_ns();
+    u64 elapsed = min_t(u64, now - p->bus_refill, NSEC_PER_SEC);
+    s64 cap;
+
+    p->bus_refill = now;
+    if (!budget || budget >= 1000) {
+        p->bus_tokens = 0;
+        return 0;
+    }
+    cap = div_u64((u64)NSEC_PER_SEC * budget, 1000);
+    cost = min_t(u64, cost, cap);
+    p->bus_tokens = min_t(s64, p->bus_tokens + div_u64(elapsed * budget, 1000), cap);
+    if (p->bus_tokens >= (s64)cost) return 0;
+    return nsecs_to_jiffies(div_u64((cost - p->bus_tokens) * 1000, budget)) + 1;
+}
+
+/*
+ * Sends the units of a flush (the address and data messages of a window,
+ * or a scroll command) in i2c_transfer() calls of about flush_chunk bytes.
+ * The adapter is released between the calls, so other clients on the bus
+ * get their turn during a full frame. A unit is never split.
+ */
+static int oled_transfer_chunked(struct oled_panel *p, struct i2c_msg *msgs, int nmsgs,
+                                 const int *unit, const int *unit_len, int nunits) {
+    unsigned int chunk = READ_ONCE(flush_chunk);
+    int i, j, bytes, first, n, ret;
+
+    for (i = 0; i < nunits; i = j) {
+        bytes = unit_len[i];
+        for (j = i + 1; j < nunits && (!chunk || bytes + unit_len[j] <= chunk); j++) {
+            bytes += unit_len[j];
+        }
+        first = unit[i];
+        n = (j < nunits ? unit[j] : nmsgs) - first;
+        ret = i2c_transfer(p->client->adapter, &msgs[first], n);
+        if (ret != n) return ret < 0 ? ret : -EIO;
+        spin_lock(&p->stats_lock);
+        p->stats.chunks++;
+        spin_unlock(&p->stats_lock);
     }
+    return 0;
+}
 
-    kfree(transfer_buf);
+// Called by the flush worker after every successful transfer
+static void oled_account_flush(struct oled_panel *p, int bytes, u64 ns) {
+    struct oled_stats *s = &p->stats;
+    bool new_frame = p->out_seq != p->out.seq;
+
+    spin_lock(&p->stats_lock);
+    s->flushes++;
+    s->i2c_ns_last = ns;
+    s->i2c_ns_max = max(s->i2c_ns_max, ns);
+    s->i2c_ns_total += ns;
+    s->bytes_last = bytes;
+    s->bytes_max = max_t(unsigned int, s->bytes_max, bytes);
+    s->bytes_total += bytes;
+    if (new_frame) {
+        // Commits in between were overwritten in the front buffer before the worker copied it
+        s->frames_dropped += p->out.seq - p->out_seq - 1;
+        s->frames_sent++;
+        s->fps_count++;
+    }
+    if (time_after_eq(jiffies, s->fps_since + HZ)) {
+        s->fps = s->fps_count * HZ / (jiffies - s->fps_since);
+        s->fps_count = 0;
+        s->fps_since = jiffies;
+    }
+    spin_unlock(&p->stats_lock);
+    p->out_seq = p->out.seq;
+}
+
+// Called with p->lock held after a frame was drawn into the back buffer
+static void oled_account_render(struct oled_panel *p, unsigned int dirty, u64 t0) {
+    u64 ns = ktime_get_ns() - t0;
+
+    trace_oled_render(dirty, ns);
+    spin_lock(&p->stats_lock);
+    p->frames_rendered++;
+    p->stats.render_ns_last = ns;
+    p->stats.render_ns_max = max(p->stats.render_ns_max, ns);
+    p->stats.render_ns_total += ns;
+    spin_unlock(&p->stats_lock);
 }
 
-// OLED Ʈѷ ʱȭ (SSD1306 )
-static void oled_init_sequence(void)
+/*
+ * Sends the frame in out, only what differs from the shadow, the copy of
+ * what the panel already shows. Consecutive changed pages share one window
+ * while that is cheaper than the address commands of a new one and the
+ * window still fits in a flush_chunk, so a clock tick costs a few dozen
+ * bytes instead of the whole 1 KB frame. The windows are built in the
+ * preallocated xfer_buf and sent within the bus time budget.
+ *
+ * Expanded once per geometry (oled_flush_128x64() and friends) with the
+ * page count, the addressing mode and the column offset as constants, so
+ * every loop bound and addressing branch is resolved at compile time.
+ * Only the flush is specialized: the render primitives (oled_draw.h) clip
+ * against p->geo->height once per call, not once per byte.
+ */
+static __always_inline void __oled_flush(struct oled_panel *p, const int pages, const bool page_mode, const int col_offset) {
+    static const unsigned char scroll_stop[] = { 0x2E };
+    const int mp = p->geo->marquee_page;
+    const unsigned char scroll_start[] = {
+        0x27, 0x00, mp, OLED_SCROLL_INTERVAL, mp, 0x00, 0xFF, // Left Horizontal Scroll
+        0x2F,                                                 // Activate Scroll
+    };
+    struct i2c_msg msgs[2 * OLED_MAX_PAGES + 2];
+    struct { unsigned char c0, c1, p0, p1; } win[OLED_MAX_PAGES];
+    int unit[OLED_MAX_PAGES + 2], unit_len[OLED_MAX_PAGES + 2], nunits = 0;
+    int lo[OLED_MAX_PAGES], hi[OLED_MAX_PAGES];
+    int page, dirty, merged, c0 = 0, c1 = -1, p0 = -1, ret;
+    int nmsgs = 0, pos = 0, sent = 0, i, nwin = 0, origin = 0;
+    unsigned int chunk = READ_ONCE(flush_chunk);
+    unsigned long wait;
+    u64 t0, ns;
+    bool marquee = p->geo->hw_scroll && p->out.marquee_len && !atomic_read(&p->fb_users);
+    bool resync, feed = false;
+    int steps = 0;
+
+    // Stop the scroll and rewrite the marquee page only for a new or removed strip or when it is due
+    if (p->scrolling) {
+        steps = oled_marquee_steps(p);
+        resync = !marquee || p->marquee_gen != p->out.marquee_gen || steps > p->marquee_fed ||
+                 steps >= OLED_MARQUEE_RESYNC;
+        feed = !resync && steps == p->marquee_fed;
+    } else {
+        resync = marquee;
+    }
+    if (p->scrolling && !resync) {
+        // The panel owns the marquee page until the next resync
+        p->out_pages &= ~(1 << mp);
+    } else if (p->scrolling) {
+        // After a scroll the page the panel shows is unknown
+        p->stale_pages |= 1 << mp;
+    }
+    if (resync && marquee) {
+        origin = oled_marquee_sync(p);
+        p->out_pages |= 1 << mp;
+    }
+
+    if (!oled_find_dirty(p, lo, hi, pages) && !resync && !feed) {
+        // oled_commit_frame() moved the next wrap column up to now: queue it again
+        if (p->scrolling) queue_delayed_work(system_wq, &p->flush_work, oled_marquee_wait(p));
+        return;
+    }
+
+    if (p->scrolling && resync) {
+        unit[nunits] = nmsgs;
+        unit_len[nunits++] = sizeof(scroll_stop) + 1;
+        oled_add_cmds(p, msgs, &nmsgs, &pos, scroll_stop, sizeof(scroll_stop));
+    }
+
+    if (feed) {
+        // Goes first: column 0 wraps to the right edge with the next step and must hold what shows there
+        p->out.pix[mp * SCREEN_WIDTH] =
+            p->out.marquee[(p->marquee_origin + steps + SCREEN_WIDTH) % p->out.marquee_len];
+        unit[nunits] = nmsgs;
+        unit_len[nunits] = pos;
+        oled_add_window(p, msgs, &nmsgs, &pos, 0, 0, mp, mp, page_mode, col_offset);
+        unit_len[nunits] = pos - unit_len[nunits];
+        nunits++;
+    }
+
+    for (page = 0; page <= pages; page++) {
+        dirty = page < pages && hi[page] >= lo[page];
+        if (!page_mode && p0 >= 0 && dirty) {
+            merged = (max(c1, hi[page]) - min(c0, lo[page]) + 1) * (page - p0 + 1);
+            if (merged <= (c1 - c0 + 1) * (page - p0) + (hi[page] - lo[page] + 1) + OLED_WINDOW_COST &&
+                (!chunk || merged + OLED_WINDOW_COST + 2 <= chunk)) {
+                c0 = min(c0, lo[page]);
+                c1 = max(c1, hi[page]);
+                continue;
+            }
+        }
+        if (p0 >= 0) {
+            unit[nunits] = nmsgs;
+            unit_len[nunits] = pos;
+            oled_add_window(p, msgs, &nmsgs, &pos, c0, c1, p0, page - 1, page_mode, col_offset);
+            unit_len[nunits] = pos - unit_len[nunits];
+            nunits++;
+            win[nwin].c0 = c0;
+            win[nwin].c1 = c1;
+            win[nwin].p0 = p0;
+            win[nwin].p1 = page - 1;
+            nwin++;
+            p0 = -1;
+        }
+        if (dirty) {
+            p0 = page;
+            c0 = lo[page];
+            c1 = hi[page];
+        }
+    }
+
+    if (resync && marquee) {
+        unit[nunits] = nmsgs;
+        unit_len[nunits++] = sizeof(scroll_start) + 1;
+        oled_add_cmds(p, msgs, &nmsgs, &pos, scroll_start, sizeof(scroll_start));
+    }
+
+    wait = oled_bus_admit(p, oled_bus_ns(p, pos, nmsgs));
+    if (wait) {
+        // Over budget: give the pages back to the front buffer and try again once the bus time is credited
+        spin_lock(&p->frame_lock);
+        p->front_pages |= p->out_pages;
+        spin_unlock(&p->frame_lock);
+        spin_lock(&p->stats_lock);
+        p->stats.throttled++;
+        spin_unlock(&p->stats_lock);
+        queue_delayed_work(system_wq, &p->flush_work, wait);
+        return;
+    }
+
+    // غ ۸ I2C  , flush_chunk   ٸ ġ    ְ
+    t0 = ktime_get_ns();
+    ret = oled_transfer_chunked(p, msgs, nmsgs, unit, unit_len, nunits);
+    ns = ktime_get_ns() - t0;
+    p->bus_tokens -= ns;
+    if (ret) {
+        // г   𸣹Ƿ  ü ٽ 
+        p->shadow_valid = false;
+        p->scrolling = false;
+        trace_oled_flush(nwin, 0, pos, ns, ret);
+        spin_lock(&p->stats_lock);
+        p->stats.flush_errors++;
+        spin_unlock(&p->stats_lock);
+        dev_err_ratelimited(&p->client->dev, "Failed to flush buffer to screen: %d\n", ret);
+        return;
+    }
+
+    p->stale_pages = 0;
+    if (resync) {
+        p->scrolling = marquee;
+        p->marquee_since = jiffies;
+        p->marquee_fed = 0;
+    } else if (feed) {
+        p->marquee_fed++;
+    }
+    if (resync && marquee) {
+        // Only now: a throttled or failed flush must retry from the old origin and time
+        p->marquee_gen = p->out.marquee_gen;
+        p->marquee_origin = origin;
+    }
+    if (p->scrolling) {
+        // Does nothing if a new frame already queued the worker to run right away
+        queue_delayed_work(system_wq, &p->flush_work, oled_marquee_wait(p));
+    }
+
+    for (i = 0; i < nwin; i++) {
+        int width = win[i].c1 - win[i].c0 + 1;
+
+        for (page = win[i].p0; page <= win[i].p1; page++) {
+            memcpy(&p->shadow[page * SCREEN_WIDTH + win[i].c0], &p->out.pix[page * SCREEN_WIDTH + win[i].c0], width);
+        }
+        sent += width * (win[i].p1 - win[i].p0 + 1);
+    }
+    p->shadow_valid = true;
+    trace_oled_flush(nwin, sent, pos, ns, 0);
+    oled_account_flush(p, pos, ns);
+}
+
+static void oled_flush_128x64(struct oled_panel *p) {
+    __oled_flush(p, 8, false, 0);
+}
+
+static void oled_flush_128x32(struct oled_panel *p) {
+    __oled_flush(p, 4, false, 0);
+}
+
+static void oled_flush_sh1106(struct oled_panel *p) {
+    __oled_flush(p, 8, true, 2);
+}
+
+/*
+ * Runs for every committed frame and, while the title scrolls, every
+ * scroll step. Frames committed during a transfer are
+ * folded into one: the worker only ever sends the latest front buffer.
+ */
+static void oled_flush_work_fn(struct work_struct *work) {
+    struct oled_panel *p = container_of(to_delayed_work(work), struct oled_panel, flush_work);
+
+    spin_lock(&p->frame_lock);
+    memcpy(&p->out, p->front, sizeof(p->out));
+    p->out_pages = p->front_pages;
+    p->front_pages = 0;
+    spin_unlock(&p->frame_lock);
+
+    p->geo->flush(p);
+}
+
+/*
+ * Publishes the back buffer, in which pages (bit n = page n) were drawn,
+ * as the new front buffer; called with p->lock held.
+ * The renderers only redraw what changed, so the new back buffer starts as
+ * a copy of the frame just committed. The flush worker never reads the
+ * back buffer, so the copy needs no spinlock.
+ */
+static void oled_commit_frame(struct oled_panel *p, unsigned int pages) {
+    struct oled_frame *done = p->back;
+
+    // Called under lock; after oled_remove() the panel may be off the bus
+    if (p->removing) return;
+
+    spin_lock(&p->frame_lock);
+    done->seq = p->front->seq + 1;
+    p->front_pages |= pages;
+    p->back = p->front;
+    p->front = done;
+    spin_unlock(&p->frame_lock);
+
+    memcpy(p->back, p->front, sizeof(*p->back));
+    mod_delayed_work(system_wq, &p->flush_work, 0);
+}
+
+// OLED Ʈѷ ʱȭ (SSD1306 , SH1106    ּ  ĸ ٸ)
+static void oled_init_sequence(struct oled_panel *p)
 {
+    const struct oled_geometry *geo = p->geo;
+    unsigned char cmds[OLED_CMD_MAX];
+    int n = 0;
+
+    cmds[n++] = 0xAE;                       // Display OFF
+    cmds[n++] = 0xD5; cmds[n++] = 0x80;     // Set Display Clock Divide Ratio/Oscillator Frequency
+    cmds[n++] = 0xA8; cmds[n++] = geo->height - 1; // Set MUX Ratio
+    cmds[n++] = 0xD3; cmds[n++] = 0x00;     // Set Display Offset
+    cmds[n++] = 0x40;                       // Set Display Start Line
+    if (geo->page_mode) {
+        cmds[n++] = 0xAD; cmds[n++] = 0x8B; // DC-DC Control, built-in DC-DC on
+    } else {
+        cmds[n++] = 0x8D; cmds[n++] = 0x14; // Charge Pump Setting, Enable Charge Pump
+        cmds[n++] = 0x20; cmds[n++] = 0x00; // Set Memory Addressing Mode, Horizontal Addressing Mode
+    }
+    cmds[n++] = 0xA1;                       // Set Segment Re-map (column 127 mapped to SEG0)
+    cmds[n++] = 0xC8;                       // Set COM Output Scan Direction (reversed)
+    cmds[n++] = 0xDA; cmds[n++] = geo->com_pins; // Set COM Pins Hardware Configuration
+    cmds[n++] = 0x81; cmds[n++] = 0xCF;     // Set Contrast Control
+    cmds[n++] = 0xD9; cmds[n++] = 0xF1;     // Set Pre-charge Period
+    cmds[n++] = 0xDB; cmds[n++] = 0x40;     // Set VCOMH Deselect Level
+    cmds[n++] = 0xA4;                       // Entire Display ON from RAM
+    cmds[n++] = 0xA6;                       // Set Normal Display
+    cmds[n++] = 0xAF;                       // Display ON
+
     msleep(20); //  ȭ 
-    oled_send_cmd(0xAE); // Display OFF
-    oled_send_cmd(0xD5); // Set Display Clock Divide Ratio/Oscillator Frequency
-    oled_send_cmd(0x80);
-    oled_send_cmd(0xA8); // Set MUX Ratio
-    oled_send_cmd(0x3F); // 64 MUX
-    oled_send_cmd(0xD3); // Set Display Offset
-    oled_send_cmd(0x00);
-    oled_send_cmd(0x40); // Set Display Start Line
-    oled_send_cmd(0x8D); // Charge Pump Setting
-    oled_send_cmd(0x14); // Enable Charge Pump
-    oled_send_cmd(0x20); // Set Memory Addressing Mode
-    oled_send_cmd(0x00); // Horizontal Addressing Mode
-    oled_send_cmd(0xA1); // Set Segment Re-map (column 127 mapped to SEG0)
-    oled_send_cmd(0xC8); // Set COM Output Scan Direction (reversed)
-    oled_send_cmd(0xDA); // Set COM Pins Hardware Configuration
-    oled_send_cmd(0x12);
-    oled_send_cmd(0x81); // Set Contrast Control
-    oled_send_cmd(0xCF);
-    oled_send_cmd(0xD9); // Set Pre-charge Period
-    oled_send_cmd(0xF1);
-    oled_send_cmd(0xDB); // Set VCOMH Deselect Level
-    oled_send_cmd(0x40);
-    oled_send_cmd(0xA4); // Entire Display ON from RAM
-    oled_send_cmd(0xA6); // Set Normal Display
-    oled_send_cmd(0xAF); // Display ON
-    printk(KERN_INFO "[OLED] Controller initialized.\n");
+    // ɾ ü   I2C 
+    oled_send_cmds(p, cmds, n);
 }
 
 
 // ===================================================================
-// == ׷ Լ ( ) ==
+// == ׷ Լ ==
 // ===================================================================
 //  ʱȭ ( 0)
-static void oled_clear_buffer(void) {
-    memset(oled_buffer, 0x00, sizeof(oled_buffer));
+static void oled_clear_buffer(struct oled_panel *p) {
+    memset(p->back->pix, 0x00, sizeof(p->back->pix));
 }
-// Ư ġ ȼ ׸
-static void oled_draw_pixel(int x, int y, int color) {
-    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
-        return;
+
+// Primitives on the back buffer, the page arithmetic is in oled_draw.h
+static void oled_blit_column(struct oled_panel *p, int x, int y, unsigned char bits) {
+    oled_draw_column(p->back->pix, p->geo->height, x, y, bits);
+}
+
+// 簢    ũ äų(color=1) (color=0)
+static void oled_fill_span(struct oled_panel *p, int x, int y, int w, int h, int color) {
+    oled_draw_span(p->back->pix, p->geo->height, x, y, w, h, color);
+}
+
+// 簢 ׸
+static void oled_draw_rect(struct oled_panel *p, int x, int y, int w, int h, int fill) {
+    oled_draw_box(p->back->pix, p->geo->height, x, y, w, h, fill);
+}
+// ===================================================================
+// == ؽƮ (glyph atlas, text run cache) ==
+// ===================================================================
+// Next code point of a UTF-8 string; malformed bytes come back as U+FFFD, which has no glyph
+static u32 oled_utf8_next(const char **str) {
+    const unsigned char *c = (const unsigned char *)*str;
+    u32 cp;
+    int n, i;
+
+    if (c[0] < 0x80) {
+        *str += 1;
+        return c[0];
     }
-    if (color) {
-        oled_buffer[x + (y / 8) * SCREEN_WIDTH] |= (1 << (y % 8));
+    if ((c[0] & 0xE0) == 0xC0) {
+        n = 1;
+        cp = c[0] & 0x1F;
+    } else if ((c[0] & 0xF0) == 0xE0) {
+        n = 2;
+        cp = c[0] & 0x0F;
+    } else if ((c[0] & 0xF8) == 0xF0) {
+        n = 3;
+        cp = c[0] & 0x07;
     } else {
-        oled_buffer[x + (y / 8) * SCREEN_WIDTH] &= ~(1 << (y % 8));
+        *str += 1;
+        return 0xFFFD;
+    }
+    // A cut off sequence (strncpy into song_title) stops at the terminator
+    for (i = 1; i <= n; i++) {
+        if ((c[i] & 0xC0) != 0x80) {
+            *str += i;
+            return 0xFFFD;
+        }
+        cp = cp << 6 | (c[i] & 0x3F);
     }
+    *str += n + 1;
+    return cp;
 }
-// 簢 ׸
-static void oled_draw_rect(int x, int y, int w, int h, int fill) {
-    int i, j;
-    for (i = x; i < x + w; i++) {
-        for (j = y; j < y + h; j++) {
-            if (fill) {
-                oled_draw_pixel(i, j, 1);
-            } else { // ׵θ
-                if (i == x || i == x + w - 1 || j == y || j == y + h - 1) {
-                    oled_draw_pixel(i, j, 1);
-                }
+
+// Columns of the glyph for cp, NULL if neither font5x7 nor the atlas has one
+static const unsigned char *oled_glyph(u32 cp, int *width) {
+    int lo = 0, hi = oled_nglyphs - 1, mid;
+    u32 at;
+
+    if (cp >= 0x20 && cp < 0x80) {
+        *width = 5;
+        return &font5x7[(cp - 0x20) * 5];
+    }
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        at = le32_to_cpu(oled_glyphs[mid].cp);
+        if (at == cp) {
+            *width = oled_glyphs[mid].width;
+            return oled_glyphs[mid].cols;
+        }
+        if (at < cp) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return NULL;
+}
+
+// Width in pixels, one blank column after every glyph; characters without a glyph take no space
+static int oled_text_width(const char *str) {
+    int width, total = 0;
+
+    while (*str) {
+        if (oled_glyph(oled_utf8_next(&str), &width)) total += width + 1;
+    }
+    return total;
+}
+
+/*
+ * Renders str into cols (one byte per column) and returns the width. A run
+ * wider than max returns -1, or with clip set stops at the last glyph that
+ * fits and returns the width drawn so far.
+ */
+static int oled_render_run(const char *str, unsigned char *cols, int max, bool clip) {
+    const unsigned char *g;
+    int width, x = 0;
+
+    while (*str) {
+        g = oled_glyph(oled_utf8_next(&str), &width);
+        if (!g) continue;
+        if (x + width + 1 > max) return clip ? x : -1;
+        memcpy(&cols[x], g, width);
+        cols[x + width] = 0;
+        x += width + 1;
+    }
+    return x;
+}
+
+static void oled_load_glyphs(struct device *dev) {
+    const struct firmware *fw;
+    const struct oled_glyph_hdr *hdr;
+    const struct oled_glyph *g;
+    size_t size;
+    u32 i, count;
+
+    mutex_lock(&oled_glyph_lock);
+    if (oled_glyph_tried || !*glyph_firmware) goto out;
+    oled_glyph_tried = true;
+
+    // The atlas is optional: without it only ASCII is drawn
+    if (firmware_request_nowarn(&fw, glyph_firmware, dev)) goto out;
+
+    hdr = (const struct oled_glyph_hdr *)fw->data;
+    if (fw->size < sizeof(*hdr) || memcmp(hdr->magic, OLED_GLYPH_MAGIC, sizeof(hdr->magic))) goto bad;
+    size = fw->size - sizeof(*hdr);
+    count = le32_to_cpu(hdr->count);
+    if (size % sizeof(*g) || size / sizeof(*g) != count) goto bad;
+    g = (const struct oled_glyph *)(hdr + 1);
+    for (i = 0; i < count; i++) {
+        if (!g[i].width || g[i].width > OLED_GLYPH_MAX_W) goto bad;
+        if (i && le32_to_cpu(g[i].cp) <= le32_to_cpu(g[i - 1].cp)) goto bad;
+    }
+
+    oled_glyph_fw = fw;
+    oled_glyphs = g;
+    oled_nglyphs = count;
+    dev_info(dev, "%u glyphs from %s\n", count, glyph_firmware);
+    goto out;
+
+bad:
+    dev_warn(dev, "%s is not a glyph atlas, only ASCII is shown\n", glyph_firmware);
+    release_firmware(fw);
+out:
+    mutex_unlock(&oled_glyph_lock);
+}
+
+static void oled_digits_init(void) {
+    int shift, i, j;
+
+    for (shift = 0; shift < 8; shift++) {
+        for (i = 0; i < sizeof(oled_digit_chars) - 1; i++) {
+            for (j = 0; j < 5; j++) {
+                oled_digit_cols[shift][i][j] = font5x7[(oled_digit_chars[i] - ' ') * 5 + j] << shift;
             }
+            oled_digit_cols[shift][i][5] = 0;
         }
     }
 }
+
+// ORs pre-shifted columns (see struct oled_text_run) in at x, y
+static void oled_blit_run(struct oled_panel *p, int x, int y, const u16 *cols, int w) {
+    oled_draw_run(p->back->pix, p->geo->height, x, y, cols, w);
+}
+
+// Digit fast path; false if str has other characters
+static bool oled_draw_digits(struct oled_panel *p, int x, int y, const char *str) {
+    const char *c, *d;
+
+    for (c = str; *c; c++) {
+        if (!strchr(oled_digit_chars, *c)) return false;
+    }
+    for (c = str; *c; c++, x += 6) {
+        d = strchr(oled_digit_chars, *c);
+        oled_blit_run(p, x, y, oled_digit_cols[y & 7][d - oled_digit_chars], 6);
+    }
+    return true;
+}
+
+// The cached run of str at shift, rendered on a miss; NULL if it does not fit on the panel
+static const struct oled_text_run *oled_run_get(struct oled_panel *p, const char *str, int shift) {
+    struct oled_text_run *r, *victim = &p->runs[0];
+    unsigned char cols[SCREEN_WIDTH];
+    int i, width;
+
+    if (strlen(str) >= sizeof(r->text)) return NULL;
+    for (i = 0; i < OLED_RUN_CACHE; i++) {
+        r = &p->runs[i];
+        if (r->used && r->shift == shift && !strcmp(r->text, str)) {
+            r->used = ++p->run_clock;
+            p->run_hits++;
+            return r;
+        }
+        if (r->used < victim->used) victim = r;
+    }
+
+    width = oled_render_run(str, cols, SCREEN_WIDTH, false);
+    if (width < 0) return NULL;
+    p->run_misses++;
+
+    strscpy(victim->text, str, sizeof(victim->text));
+    victim->shift = shift;
+    victim->width = width;
+    victim->used = ++p->run_clock;
+    for (i = 0; i < width; i++) victim->cols[i] = cols[i] << shift;
+    return victim;
+}
+
 // ڿ 
-static void oled_draw_string(int x, int y, const char *str) {
-    int i = 0;
+static void oled_draw_string(struct oled_panel *p, int x, int y, const char *str) {
+    const struct oled_text_run *run;
+    const unsigned char *g;
+    int width, j;
+
+    if (oled_draw_digits(p, x, y, str)) return;
+
+    run = oled_run_get(p, str, y & 7);
+    if (run) {
+        oled_blit_run(p, x, y, run->cols, run->width);
+        return;
+    }
+
+    // Wider than the panel (a clipped title): glyph by glyph, nothing to keep
     while (*str) {
-        char c = *str++;
-        int char_idx = c - ' '; // Ʈ Ϳ  ε
-        if (char_idx < 0 || char_idx > 95) continue; //  ϴ 
-
-        int j, k;
-        for (j = 0; j < 5; j++) {
-            unsigned char line = font5x7[char_idx * 5 + j];
-            for (k = 0; k < 8; k++) {
-                if ((line >> k) & 1) {
-                    oled_draw_pixel(x + i * 6 + j, y + k, 1);
-                }
-            }
+        g = oled_glyph(oled_utf8_next(&str), &width);
+        if (!g) continue;
+        for (j = 0; j < width; j++) {
+            oled_blit_column(p, x + j, y, g[j]);
         }
-        i++;
+        x += width + 1;
     }
 }
 
+// ȭ    Ű Ʈ ׸ ( ̹Ƿ ۸  ״ )
+static void oled_marquee_set(struct oled_panel *p, const char *str) {
+    unsigned char *strip = p->back->marquee;
+    int width;
+
+    memset(strip, 0, OLED_MARQUEE_MAX);
+    // Two byte UTF-8 characters with 11 column atlas glyphs can outgrow the strip: scroll what fits
+    width = oled_render_run(str, strip, OLED_MARQUEE_MAX - OLED_MARQUEE_GAP, true);
+    p->back->marquee_len = width + OLED_MARQUEE_GAP;
+    p->back->marquee_gen++;
+}
+
 // ===================================================================
-// == UI  ׸ Լ ( ) ==
+// == Retained widget layer ==
 // ===================================================================
-// 1)  ׸ (0~15  5 )
-static void draw_volume(int level) {
+static void oled_clear_rect(struct oled_panel *p, int x, int y, int w, int h) {
+    oled_fill_span(p, x, y, w, h, 0);
+}
+
+static void oled_draw_bitmap(struct oled_panel *p, int x, int y, int w, int h, const unsigned char *bitmap) {
     int i;
-    int bar_heights[] = {2, 4, 6, 8, 10}; // 5  ִ 
-    int thresholds[] = {0, 4, 7, 10, 13}; //  밡    Ӱ谪
-    
-    for (i = 0; i < 5; i++) {
-        if (level >= thresholds[i]) {
-            oled_draw_rect(10 + i * 4, 11 - bar_heights[i], 3, bar_heights[i], 1);
+    // Ʈ  8ȼ 1Ʈ Ǿ ȭ ۿ   (h  8 )
+    unsigned char mask = h >= 8 ? 0xFF : (1 << h) - 1;
+    for (i = 0; i < w; i++) {
+        oled_blit_column(p, x + i, y, bitmap[i] & mask);
+    }
+}
+
+// 128x64 ȭ ġ:  UI   , ش Ҹ ٽ ׸    
+static const struct oled_widget oled_layout_64[OLED_W_COUNT] = {
+    // 1)  ܰ 5 
+    [OLED_W_SPEAKER]  = { .kind = OLED_WK_ICON, .box = {  2,  2,   7,  8 }, .icon = icon_speaker },
+    [OLED_W_VOLUME]   = { .kind = OLED_WK_BARS, .box = { 10,  0,  20, 11 }, .bars = 5, .bar_w = 3, .bar_pitch = 4 },
+    // 2)  ð, 3) Ʈ ȣ
+    [OLED_W_CLOCK]    = { .kind = OLED_WK_TEXT, .box = { 48,  2,  30,  8 } },
+    [OLED_W_TRACK]    = { .kind = OLED_WK_TEXT, .box = { 90,  2,  38,  8 } },
+    //   
+    [OLED_W_PROGRESS] = { .kind = OLED_WK_PROGRESS, .box = { 4, 16, 120,  5 } },
+    // 4) Ʈ м,  3~4 (y 24..39)
+    [OLED_W_SPECTRUM] = { .kind = OLED_WK_BARS, .box = {  0, 24, 128, 16 }, .dx = 2,
+                          .bars = OLED_SPECTRUM_BANDS, .bar_w = 3, .bar_pitch = 4 },
+    // 6)  : y 44  , ȭ   y 40 (page 5)  ϵ ũ
+    [OLED_W_TITLE]    = { .kind = OLED_WK_TEXT, .box = {  0, 40, 128, 12 }, .dy = 4,
+                          .flags = OLED_ALIGN_CENTER | OLED_ALIGN_MARQUEE },
+    // 5)   ð, 7)  ü ð
+    [OLED_W_PLAYTIME] = { .kind = OLED_WK_TEXT, .box = {  4, 54,  30,  8 } },
+    [OLED_W_TOTAL]    = { .kind = OLED_WK_TEXT, .box = { 90, 54,  30,  8 } },
+};
+
+// 128x32 ȭ ġ: Ʈ  ڸ 
+static const struct oled_widget oled_layout_32[OLED_W_COUNT] = {
+    [OLED_W_SPEAKER]  = { .kind = OLED_WK_ICON, .box = {  2,  2,   7,  8 }, .icon = icon_speaker },
+    [OLED_W_VOLUME]   = { .kind = OLED_WK_BARS, .box = { 10,  0,  20, 11 }, .bars = 5, .bar_w = 3, .bar_pitch = 4 },
+    [OLED_W_CLOCK]    = { .kind = OLED_WK_TEXT, .box = { 48,  2,  30,  8 } },
+    [OLED_W_TRACK]    = { .kind = OLED_WK_TEXT, .box = { 90,  2,  38,  8 } },
+    //  : page 2 (y 16..23), ġ   ũ
+    [OLED_W_TITLE]    = { .kind = OLED_WK_TEXT, .box = {  0, 16, 128,  8 },
+                          .flags = OLED_ALIGN_CENTER | OLED_ALIGN_MARQUEE },
+    [OLED_W_PLAYTIME] = { .kind = OLED_WK_TEXT, .box = {  4, 24,  30,  8 } },
+    [OLED_W_PROGRESS] = { .kind = OLED_WK_PROGRESS, .box = { 40, 25, 44,  5 } },
+    [OLED_W_TOTAL]    = { .kind = OLED_WK_TEXT, .box = { 90, 24,  30,  8 } },
+};
+
+static const struct oled_geometry oled_geo_128x64 = {
+    .name = "SSD1306 128x64", .height = 64, .pages = 8, .com_pins = 0x12,
+    .hw_scroll = true, .marquee_page = 5, .layout = oled_layout_64, .flush = oled_flush_128x64,
+};
+
+static const struct oled_geometry oled_geo_128x32 = {
+    .name = "SSD1306 128x32", .height = 32, .pages = 4, .com_pins = 0x02,
+    .hw_scroll = true, .marquee_page = 2, .layout = oled_layout_32, .flush = oled_flush_128x32,
+};
+
+// SH1106: 132x64 RAM, the panel shows columns 2..129; no hardware scroll, so long titles are clipped
+static const struct oled_geometry oled_geo_sh1106 = {
+    .name = "SH1106 132x64", .height = 64, .pages = 8, .col_offset = 2, .com_pins = 0x12,
+    .page_mode = true, .marquee_page = 5, .layout = oled_layout_64, .flush = oled_flush_sh1106,
+};
+
+static void oled_widget_text(struct oled_panel *p, int w, const char *text) {
+    struct oled_widget *wd = &p->widgets[w];
+
+    if (!strncmp(wd->text, text, sizeof(wd->text))) return;
+    strscpy(wd->text, text, sizeof(wd->text));
+    wd->dirty = true;
+}
+
+static void oled_widget_levels(struct oled_panel *p, int w, const unsigned char *level) {
+    struct oled_widget *wd = &p->widgets[w];
+
+    if (!memcmp(wd->level, level, wd->bars)) return;
+    memcpy(wd->level, level, wd->bars);
+    wd->dirty = true;
+}
+
+static void oled_widget_progress(struct oled_panel *p, int w, unsigned int value, unsigned int max) {
+    struct oled_widget *wd = &p->widgets[w];
+
+    if (wd->value == value && wd->max == max) return;
+    wd->value = value;
+    wd->max = max;
+    wd->dirty = true;
+}
+
+static void oled_widget_draw(struct oled_panel *p, struct oled_widget *wd) {
+    const struct oled_box *b = &wd->box;
+    int i, x, width, fill;
+
+    oled_clear_rect(p, b->x, b->y, b->w, b->h);
+
+    switch (wd->kind) {
+    case OLED_WK_TEXT:
+        width = oled_text_width(wd->text);
+        if ((wd->flags & OLED_ALIGN_MARQUEE) && p->geo->hw_scroll) {
+            if (width > b->w) {
+                // The marquee page is filled from the strip at flush time
+                oled_marquee_set(p, wd->text);
+                break;
+            }
+            p->back->marquee_len = 0;
+        }
+        x = wd->flags & OLED_ALIGN_CENTER ? b->x + (b->w - width) / 2 : b->x + wd->dx;
+        oled_draw_string(p, x, b->y + wd->dy, wd->text);
+        break;
+    case OLED_WK_BARS:
+        for (i = 0; i < wd->bars; i++) {
+            if (!wd->level[i]) continue;
+            oled_draw_rect(p, b->x + wd->dx + i * wd->bar_pitch, b->y + b->h - wd->level[i], wd->bar_w, wd->level[i], 1);
+        }
+        break;
+    case OLED_WK_ICON:
+        oled_draw_bitmap(p, b->x, b->y, b->w, b->h, wd->icon);
+        break;
+    case OLED_WK_PROGRESS:
+        oled_draw_rect(p, b->x, b->y, b->w, b->h, 0);
+        fill = wd->max ? (b->w - 2) * min(wd->value, wd->max) / wd->max : 0;
+        oled_fill_span(p, b->x + 1, b->y + 1, fill, b->h - 2, 1);
+        break;
+    }
+}
+
+// Draws every dirty widget into the back buffer; returns the pages drawn (bit n = page n)
+static unsigned int oled_widgets_render(struct oled_panel *p) {
+    struct oled_widget *wd;
+    unsigned int pages = 0;
+    int w;
+
+    for (w = 0; w < OLED_W_COUNT; w++) {
+        wd = &p->widgets[w];
+        if (!wd->dirty || wd->kind == OLED_WK_NONE) continue;
+        oled_widget_draw(p, wd);
+        wd->dirty = false;
+        pages |= GENMASK((wd->box.y + wd->box.h - 1) / 8, wd->box.y / 8);
+    }
+    return pages;
+}
+
+// "MM:SS" -> seconds, 0 if it does not parse
+static unsigned int oled_parse_mmss(const char *s) {
+    unsigned int min, sec;
+
+    if (sscanf(s, "%u:%u", &min, &sec) != 2) return 0;
+    return min * 60 + sec;
+}
+
+// Moves the bars toward the shared levels: up at once, down one pixel per call
+static bool oled_spectrum_step(struct oled_panel *p, bool snap) {
+    int i, target;
+    bool changed = false;
+
+    for (i = 0; i < OLED_SPECTRUM_BANDS; i++) {
+        target = min_t(int, READ_ONCE(oled_levels->levels[i]), 15);
+        if (target == p->bar_height[i]) continue;
+        if (snap || target > p->bar_height[i]) {
+            p->bar_height[i] = target;
+        } else {
+            p->bar_height[i]--;
         }
+        changed = true;
     }
+    return changed;
 }
-// 4) Ʈ м ִϸ̼ ( )
-static void draw_spectrum_analyzer(void) {
+
+static void oled_queue_spectrum(struct oled_panel *p);
+
+static void oled_spectrum_work_fn(struct work_struct *work) {
+    struct oled_panel *p = container_of(work, struct oled_panel, spectrum_work);
+    unsigned int pages;
+    u64 t0;
+
+    if (atomic_read(&p->fb_users)) return;
+
+    mutex_lock(&p->lock);
+    if (p->spectrum_running && READ_ONCE(oled_levels->seq) && oled_spectrum_step(p, false)) {
+        t0 = ktime_get_ns();
+        oled_widget_levels(p, OLED_W_SPECTRUM, p->bar_height);
+        pages = oled_widgets_render(p);
+        oled_account_render(p, 1 << OLED_W_SPECTRUM, t0);
+        if (pages) oled_commit_frame(p, pages);
+    }
+    mutex_unlock(&p->lock);
+}
+
+static enum hrtimer_restart oled_spectrum_timer_fn(struct hrtimer *timer) {
+    struct oled_panel *p = container_of(timer, struct oled_panel, spectrum_timer);
+    unsigned int fps = READ_ONCE(spectrum_fps);
+
+    if (!fps || !READ_ONCE(p->spectrum_running)) return HRTIMER_NORESTART;
+
+    // I2C may sleep, so the frame itself is drawn from a work item
+    schedule_work(&p->spectrum_work);
+    hrtimer_forward_now(timer, ns_to_ktime(NSEC_PER_SEC / fps));
+    return HRTIMER_RESTART;
+}
+
+static void oled_spectrum_start(struct oled_panel *p) {
+    unsigned int fps = READ_ONCE(spectrum_fps);
+
+    if (p->removing) return;
+    if (fps && p->widgets[OLED_W_SPECTRUM].kind != OLED_WK_NONE) {
+        hrtimer_start(&p->spectrum_timer, ns_to_ktime(NSEC_PER_SEC / fps), HRTIMER_MODE_REL);
+    }
+}
+
+// With spectrum_fps at 0 the timers stopped themselves; raising it restarts the running ones
+static int spectrum_fps_set(const char *val, const struct kernel_param *kp) {
+    unsigned int old = READ_ONCE(spectrum_fps);
+    struct oled_panel *p;
+    int i, ret;
+
+    ret = param_set_uint(val, kp);
+    if (ret || old || !READ_ONCE(spectrum_fps)) return ret;
+
+    // A panel still in the table is not past oled_remove() cancelling its timer
+    spin_lock(&oled_panels_lock);
+    for (i = 0; i < OLED_MAX_PANELS; i++) {
+        p = oled_panels[i];
+        if (p && READ_ONCE(p->spectrum_running)) oled_spectrum_start(p);
+    }
+    spin_unlock(&oled_panels_lock);
+    return 0;
+}
+
+/*
+ * New spectrum levels (0~15 per band) from another kernel module. Lock-free:
+ * the bytes are stored as they are and the animation of every panel picks
+ * them up on its next frame. Only for a single producer, see oled_levels.
+ */
+int oled_spectrum_update(const unsigned char *levels, int n) {
     int i;
-    for (i = 0; i < 32; i++) {
-        unsigned int rand;
-        get_random_bytes(&rand, sizeof(rand));
-        int height = rand % 16; // 0~15   
-        oled_draw_rect(2 + i * 4, 38 - height, 3, height, 1);
-    }
-}
-
-static void oled_draw_bitmap(int x, int y, int w, int h, const unsigned char *bitmap) {
-    int i, j;
-    // Ʈ  ȼ ȸ
-    for (j = 0; j < h; j++) { //  (y)
-        for (i = 0; i < w; i++) { //  (x)
-            // Ʈ Ϳ  ȼ  ִ Ȯ
-            // (Ʈ  8ȼ 1Ʈ )
-            if ( (bitmap[i] >> j) & 1 ) {
-                //  ִٸ, ȭ ش ġ ȼ ׸
-                oled_draw_pixel(x + i, y + j, 1);
-            }
+
+    if (!oled_levels) return -ENODEV;
+    if (n > OLED_SPECTRUM_BANDS) n = OLED_SPECTRUM_BANDS;
+
+    memcpy(oled_levels->levels, levels, n);
+    smp_wmb();
+    WRITE_ONCE(oled_levels->seq, oled_levels->seq + 1);
+
+    // Without the animation the bars only move when the spectrum widget is redrawn
+    if (!READ_ONCE(spectrum_fps)) {
+        spin_lock(&oled_panels_lock);
+        for (i = 0; i < OLED_MAX_PANELS; i++) {
+            if (oled_panels[i]) oled_queue_spectrum(oled_panels[i]);
         }
+        spin_unlock(&oled_panels_lock);
     }
+    return 0;
 }
+EXPORT_SYMBOL_GPL(oled_spectrum_update);
 
-// UI ü Ʈ
-static void update_display(struct mp3_ui_data *data) {
+// Hands the fields of st to the widgets whose bit is set in dirty
+static void oled_widgets_feed(struct oled_panel *p, const struct oled_ui_state *st, unsigned int dirty) {
+    static const unsigned char bar_heights[] = {2, 4, 6, 8, 10}; // 5  ִ 
+    static const unsigned char thresholds[] = {0, 4, 7, 10, 13}; //  밡    Ӱ谪
+    unsigned char level[OLED_SPECTRUM_BANDS] = { 0 };
     char temp_str[16];
+    unsigned int rand;
+    int i;
+
+    if (dirty & (1 << OLED_W_VOLUME)) {
+        // 0~15  5 
+        for (i = 0; i < ARRAY_SIZE(bar_heights); i++) {
+            level[i] = st->ui.volume >= thresholds[i] ? bar_heights[i] : 0;
+        }
+        oled_widget_levels(p, OLED_W_VOLUME, level);
+    }
+    if (dirty & (1 << OLED_W_CLOCK)) oled_widget_text(p, OLED_W_CLOCK, st->ui.current_time);
+    if (dirty & (1 << OLED_W_TRACK)) {
+        snprintf(temp_str, sizeof(temp_str), "%02d/%02d", st->ui.track_current, st->ui.track_total);
+        oled_widget_text(p, OLED_W_TRACK, temp_str);
+    }
+    if (dirty & (1 << OLED_W_PROGRESS)) {
+        oled_widget_progress(p, OLED_W_PROGRESS, oled_parse_mmss(st->ui.playback_time), oled_parse_mmss(st->ui.total_time));
+    }
+    if (dirty & (1 << OLED_W_SPECTRUM)) {
+        if (!st->ui.spectrum_run_stop && !p->spectrum_running) oled_spectrum_start(p);
+        p->spectrum_running = !st->ui.spectrum_run_stop;
+        memset(level, 0, sizeof(level));
+        if (p->spectrum_running && READ_ONCE(oled_levels->seq)) {
+            // Between timer frames only the animation moves the bars
+            if (!READ_ONCE(spectrum_fps)) oled_spectrum_step(p, true);
+            memcpy(level, p->bar_height, sizeof(level));
+        } else if (p->spectrum_running) {
+            // levels   0~15   
+            for (i = 0; i < OLED_SPECTRUM_BANDS; i++) {
+                get_random_bytes(&rand, sizeof(rand));
+                level[i] = rand % 16;
+            }
+        }
+        oled_widget_levels(p, OLED_W_SPECTRUM, level);
+    }
+    if (dirty & (1 << OLED_W_TITLE)) oled_widget_text(p, OLED_W_TITLE, st->title);
+    if (dirty & (1 << OLED_W_PLAYTIME)) oled_widget_text(p, OLED_W_PLAYTIME, st->ui.playback_time);
+    if (dirty & (1 << OLED_W_TOTAL)) oled_widget_text(p, OLED_W_TOTAL, st->ui.total_time);
+}
+
+/*
+ * Feeds st to the widgets in dirty (OLED_DIRTY_* bits), redraws those whose
+ * state actually changed and commits the frame. Only their boxes are
+ * cleared, so everything else in the back buffer, and therefore on the
+ * panel, stays as it is; a frame in which nothing changed is not committed.
+ */
+static void update_display(struct oled_panel *p, const struct oled_ui_state *st, unsigned int dirty) {
+    u64 t0 = ktime_get_ns();
+    unsigned int pages = 0;
+    int w;
+
+    if (dirty & OLED_DIRTY_REDRAW) {
+        oled_clear_buffer(p);
+        for (w = 0; w < OLED_W_COUNT; w++) p->widgets[w].dirty = true;
+        pages = GENMASK(p->geo->pages - 1, 0);
+    }
+
+    oled_widgets_feed(p, st, dirty);
+    pages |= oled_widgets_render(p);
+    oled_account_render(p, dirty, t0);
+
+    // ϼ ۸ front  ѱ  flush worker  ñ
+    if (pages) oled_commit_frame(p, pages);
+}
+
+// ===================================================================
+// == Asynchronous renderer ==
+// ===================================================================
+/*
+ * write() and the field ioctls only update p->next and mark the affected
+ * widgets dirty, then schedule the panel's render_work. The worker renders
+ * at most max_fps times a second; anything written in between is folded
+ * into the pending frame, so a burst of updates becomes a single render and
+ * flush.
+ */
+static void oled_schedule_render(struct oled_panel *p) {
+    unsigned int fps = READ_ONCE(max_fps);
+    unsigned long next, delay = 0;
+
+    if (fps) {
+        next = p->last_render + HZ / fps;
+        if (time_after(next, jiffies)) delay = next - jiffies;
+    }
+
+    // Files may outlive the panel's removal; their writes are dropped from then on
+    spin_lock(&p->pending_lock);
+    if (!p->removing) schedule_delayed_work(&p->render_work, delay);
+    spin_unlock(&p->pending_lock);
+}
+
+static void oled_render_work_fn(struct work_struct *work) {
+    struct oled_panel *p = container_of(to_delayed_work(work), struct oled_panel, render_work);
+    struct oled_ui_state st;
+    unsigned int dirty;
+
+    // An open framebuffer owns the panel; the frame stays pending until it is closed
+    if (atomic_read(&p->fb_users)) return;
+
+    spin_lock(&p->pending_lock);
+    dirty = p->next_dirty;
+    if (!dirty) {
+        spin_unlock(&p->pending_lock);
+        return;
+    }
+    st = p->next;
+    p->next_dirty = 0;
+    spin_unlock(&p->pending_lock);
+
+    p->last_render = jiffies;
+    mutex_lock(&p->lock);
+    update_display(p, &st, dirty);
+    mutex_unlock(&p->lock);
+}
+
+static void oled_queue_dirty(struct oled_panel *p, unsigned int dirty) {
+    if (p->next_dirty) p->frames_coalesced++;
+    p->next_dirty |= dirty;
+}
+
+static void oled_queue_spectrum(struct oled_panel *p) {
+    spin_lock(&p->pending_lock);
+    oled_queue_dirty(p, 1 << OLED_W_SPECTRUM);
+    spin_unlock(&p->pending_lock);
+
+    oled_schedule_render(p);
+}
+
+// A whole mp3_ui_data from write(): every widget compares its fields
+static void oled_queue_frame(struct oled_panel *p, const struct mp3_ui_data *data) {
+    spin_lock(&p->pending_lock);
+    oled_queue_dirty(p, OLED_DIRTY_ALL);
+    p->next.ui = *data;
+    strscpy(p->next.title, data->song_title, sizeof(p->next.title));
+    spin_unlock(&p->pending_lock);
+
+    oled_schedule_render(p);
+}
+
+// Field ioctls: only the widget that shows the field is redrawn
+static long oled_queue_field(struct oled_panel *p, unsigned int cmd, const union oled_field *f) {
+    spin_lock(&p->pending_lock);
+    switch (cmd) {
+    case OLED_SET_VOLUME:
+        p->next.ui.volume = f->volume;
+        oled_queue_dirty(p, 1 << OLED_W_VOLUME);
+        break;
+    case OLED_SET_CLOCK:
+        strscpy(p->next.ui.current_time, f->time, sizeof(p->next.ui.current_time));
+        oled_queue_dirty(p, 1 << OLED_W_CLOCK);
+        break;
+    case OLED_SET_TRACK:
+        p->next.ui.track_current = f->track.current;
+        p->next.ui.track_total = f->track.total;
+        oled_queue_dirty(p, 1 << OLED_W_TRACK);
+        break;
+    case OLED_SET_PLAYBACK_TIME:
+        strscpy(p->next.ui.playback_time, f->time, sizeof(p->next.ui.playback_time));
+        oled_queue_dirty(p, 1 << OLED_W_PLAYTIME | 1 << OLED_W_PROGRESS);
+        break;
+    case OLED_SET_TOTAL_TIME:
+        strscpy(p->next.ui.total_time, f->time, sizeof(p->next.ui.total_time));
+        oled_queue_dirty(p, 1 << OLED_W_TOTAL | 1 << OLED_W_PROGRESS);
+        break;
+    case OLED_SET_TITLE:
+        strscpy(p->next.title, f->title, sizeof(p->next.title));
+        oled_queue_dirty(p, 1 << OLED_W_TITLE);
+        break;
+    case OLED_SET_SPECTRUM_RUN:
+        p->next.ui.spectrum_run_stop = f->run_stop;
+        oled_queue_dirty(p, 1 << OLED_W_SPECTRUM);
+        break;
+    default:
+        spin_unlock(&p->pending_lock);
+        return -ENOTTY;
+    }
+    spin_unlock(&p->pending_lock);
+
+    oled_schedule_render(p);
+    return 0;
+}
+
+// Probe, every open file and the framebuffer hold a reference
+static void oled_panel_free(struct kref *ref) {
+    kfree(container_of(ref, struct oled_panel, ref));
+}
+
+// ===================================================================
+// == Framebuffer (fbdev, deferred I/O) ==
+// ===================================================================
+/*
+ * Each panel is also a 128xH 1bpp framebuffer, laid out row by row like
+ * ssd1307fb. Writes through mmap are collected by fb_deferred_io and
+ * converted into the page layout of the back buffer; the shadow compare in
+ * the flush then turns that into the windows that actually changed, since
+ * the whole framebuffer fits in one memory page and the page fault
+ * tracking alone cannot narrow it down.
+ */
+static void oled_fb_update(struct oled_panel *p, int p0, int p1) {
+    unsigned char *vmem = p->fb_info->screen_buffer;
+    int line_length = p->fb_info->fix.line_length;
+    int page, col, bit;
+    unsigned char byte;
+
+    mutex_lock(&p->lock);
+    for (page = p0; page <= p1; page++) {
+        for (col = 0; col < SCREEN_WIDTH; col++) {
+            byte = 0;
+            for (bit = 0; bit < 8; bit++) {
+                if ((vmem[(page * 8 + bit) * line_length + col / 8] >> (col % 8)) & 1) byte |= 1 << bit;
+            }
+            p->back->pix[page * SCREEN_WIDTH + col] = byte;
+        }
+    }
+    oled_commit_frame(p, GENMASK(p1, p0));
+    mutex_unlock(&p->lock);
+}
+
+static void oled_fb_deferred_io(struct fb_info *info, struct list_head *pagereflist) {
+    struct oled_panel *p = info->par;
+
+    oled_fb_update(p, 0, p->geo->pages - 1);
+}
+
+static void oled_fb_damage_range(struct fb_info *info, off_t off, size_t len) {
+    struct oled_panel *p = info->par;
+    int line_length = info->fix.line_length;
+
+    if (!len) return;
+    oled_fb_update(p, off / line_length / 8, min_t(int, (off + len - 1) / line_length / 8, p->geo->pages - 1));
+}
+
+static void oled_fb_damage_area(struct fb_info *info, u32 x, u32 y, u32 width, u32 height) {
+    struct oled_panel *p = info->par;
 
-    oled_clear_buffer();
-
-    // 1) 
-	oled_draw_bitmap(2, 2, 8, 8, icon_speaker);
-    draw_volume(data->volume);
-    // 2)  ð
-    oled_draw_string(48, 2, data->current_time);
-    // 3) Ʈ ȣ
-    snprintf(temp_str, sizeof(temp_str), "%02d/%02d", data->track_current, data->track_total);
-    oled_draw_string(90, 2, temp_str);
-    // 4) Ʈ м
-	if(!data->spectrum_run_stop) draw_spectrum_analyzer();
-    // 5)   ð
-    oled_draw_string(4, 54, data->playback_time);
-    // 6)   ( )
-    int title_len = strlen(data->song_title);
-    int title_x = 64 - (title_len * 6) / 2;
-    if (title_x < 0) title_x = 0;
-    oled_draw_string(title_x, 44, data->song_title);
-    // 7)  ü ð
-    oled_draw_string(90, 54, data->total_time);
-
-    // ϼ ۸ ȭ鿡 
-    oled_flush_buffer();
+    if (!height) return;
+    oled_fb_update(p, y / 8, min_t(int, (y + height - 1) / 8, p->geo->pages - 1));
+}
+
+FB_GEN_DEFAULT_DEFERRED_SYSMEM_OPS(oled_fb, oled_fb_damage_range, oled_fb_damage_area)
+
+// The last close of /dev/fbN after unregister_framebuffer(); the panel may be gone by then
+static void oled_fb_destroy(struct fb_info *info) {
+    struct oled_panel *p = info->par;
+
+    fb_deferred_io_cleanup(info);
+    free_pages((unsigned long)info->screen_buffer, get_order(info->screen_size));
+    framebuffer_release(info);
+    kref_put(&p->ref, oled_panel_free);
+}
+
+static int oled_fb_open(struct fb_info *info, int user) {
+    struct oled_panel *p = info->par;
+
+    if (user) atomic_inc(&p->fb_users);
+    return 0;
+}
+
+static int oled_fb_release(struct fb_info *info, int user) {
+    struct oled_panel *p = info->par;
+
+    // Hand the panel back to /dev/oled and redraw its latest frame from scratch
+    if (user && atomic_dec_and_test(&p->fb_users)) {
+        spin_lock(&p->pending_lock);
+        p->next_dirty = OLED_DIRTY_ALL | OLED_DIRTY_REDRAW;
+        spin_unlock(&p->pending_lock);
+        oled_schedule_render(p);
+    }
+    return 0;
+}
+
+static const struct fb_ops oled_fb_ops = {
+    .owner = THIS_MODULE,
+    .fb_open = oled_fb_open,
+    .fb_release = oled_fb_release,
+    .fb_destroy = oled_fb_destroy,
+    FB_DEFAULT_DEFERRED_OPS(oled_fb),
+};
+
+static int oled_fb_register(struct oled_panel *p) {
+    struct fb_info *info;
+    unsigned int vmem_size = SCREEN_WIDTH * p->geo->height / 8;
+    void *vmem;
+    int ret;
+
+    info = framebuffer_alloc(0, &p->client->dev);
+    if (!info) return -ENOMEM;
+
+    // Deferred I/O maps this memory into user space page by page
+    vmem = (void *)__get_free_pages(GFP_KERNEL | __GFP_ZERO, get_order(vmem_size));
+    if (!vmem) {
+        framebuffer_release(info);
+        return -ENOMEM;
+    }
+
+    info->par = p;
+    info->fbops = &oled_fb_ops;
+    info->screen_buffer = vmem;
+    info->screen_size = vmem_size;
+
+    strscpy(info->fix.id, "oledfb", sizeof(info->fix.id));
+    info->fix.type = FB_TYPE_PACKED_PIXELS;
+    info->fix.visual = FB_VISUAL_MONO10;
+    info->fix.line_length = SCREEN_WIDTH / 8;
+    info->fix.accel = FB_ACCEL_NONE;
+    info->fix.smem_start = __pa(vmem);
+    info->fix.smem_len = vmem_size;
+
+    info->var.xres = SCREEN_WIDTH;
+    info->var.xres_virtual = SCREEN_WIDTH;
+    info->var.yres = p->geo->height;
+    info->var.yres_virtual = p->geo->height;
+    info->var.bits_per_pixel = 1;
+    info->var.red.length = 1;
+    info->var.green.length = 1;
+    info->var.blue.length = 1;
+
+    p->fb_defio.delay = max_fps ? max_t(unsigned long, HZ / max_fps, 1) : HZ / 10;
+    p->fb_defio.deferred_io = oled_fb_deferred_io;
+    info->fbdefio = &p->fb_defio;
+    ret = fb_deferred_io_init(info);
+    if (ret) goto err_free;
+
+    ret = register_framebuffer(info);
+    if (ret) goto err_defio;
+
+    // Dropped by oled_fb_destroy()
+    kref_get(&p->ref);
+    p->fb_info = info;
+    return 0;
 
+err_defio:
+    fb_deferred_io_cleanup(info);
+err_free:
+    free_pages((unsigned long)vmem, get_order(vmem_size));
+    framebuffer_release(info);
+    return ret;
+}
+
+static void oled_fb_unregister(struct oled_panel *p) {
+    struct fb_info *info = p->fb_info;
+
+    if (!info) return;
+    // The rest is freed by oled_fb_destroy() once no one has the framebuffer open
+    unregister_framebuffer(info);
+    p->fb_info = NULL;
 }
 
 // ===================================================================
 // ==  ۷̼ (File Operations) -   ==
 // ===================================================================
 static int mp3_oled_open(struct inode *inode, struct file *file) {
-    printk(KERN_INFO "[OLED] Device opened.\n");
+    //  minor ȣ г,  ̸  ̻   
+    struct oled_panel *p;
+
+    spin_lock(&oled_panels_lock);
+    p = oled_panels[iminor(inode)];
+    if (p) kref_get(&p->ref);
+    spin_unlock(&oled_panels_lock);
+    if (!p) return -ENODEV;
+
+    file->private_data = p;
+    pr_debug("[OLED] panel %d opened\n", p->id);
     return 0;
 }
 static int mp3_oled_release(struct inode *inode, struct file *file) {
-    printk(KERN_INFO "[OLED] Device closed.\n");
+    struct oled_panel *p = file->private_data;
+
+    // Not dev_dbg(): the last close may come after oled_remove() destroyed the device
+    pr_debug("[OLED] panel %d closed\n", p->id);
+    kref_put(&p->ref, oled_panel_free);
     return 0;
 }
 static ssize_t mp3_oled_write(struct file *file, const char __user *user_buf, size_t count, loff_t *offs) {
+    struct oled_panel *p = file->private_data;
     struct mp3_ui_data data;
     
     if (count != sizeof(struct mp3_ui_data)) {
-        printk(KERN_WARNING "[OLED] Write size mismatch! Expected %ld, got %ld\n", sizeof(struct mp3_ui_data), count);
+        printk_ratelimited(KERN_WARNING "[OLED] Write size mismatch! Expected %ld, got %ld\n", sizeof(struct mp3_ui_data), count);
         return -EINVAL;
     }
     
     if (copy_from_user(&data, user_buf, sizeof(struct mp3_ui_data))) {
-        printk(KERN_ERR "[OLED] Failed to copy data from user.\n");
+        printk_ratelimited(KERN_ERR "[OLED] Failed to copy data from user.\n");
         return -EFAULT;
     }
 
-    printk(KERN_INFO "[OLED] Received data: vol=%d, title=%s\n", data.volume, data.song_title);
+    //   ڿ  ʾƵ ȴ, ʵ   ʵ  Ʈ 0 
+    data.current_time[sizeof(data.current_time) - 1] = '\0';
+    data.playback_time[sizeof(data.playback_time) - 1] = '\0';
+    data.song_title[sizeof(data.song_title) - 1] = '\0';
+    data.total_time[sizeof(data.total_time) - 1] = '\0';
+
+    trace_oled_write(data.volume, data.song_title, sizeof(data.song_title));
     
-    update_display(&data);
+    // Rendering and the I2C transfer happen in the panel's render_work, not here
+    oled_queue_frame(p, &data);
     
     return count;
 }
 
+static long mp3_oled_ioctl(struct file *file, unsigned int cmd, unsigned long arg) {
+    struct oled_panel *p = file->private_data;
+    union oled_field f;
+
+    if (_IOC_TYPE(cmd) != OLED_IOCTL_BASE) return -ENOTTY;
+    if (_IOC_SIZE(cmd) > sizeof(f)) return -ENOTTY;
+
+    memset(&f, 0, sizeof(f));
+    if (copy_from_user(&f, (void __user *)arg, _IOC_SIZE(cmd))) return -EFAULT;
+    f.title[sizeof(f.title) - 1] = '\0';
+
+    if (cmd == OLED_SET_SPECTRUM_LEVELS) return oled_spectrum_update(f.levels, OLED_SPECTRUM_BANDS);
+    return oled_queue_field(p, cmd, &f);
+}
+
+// The shared spectrum level page (struct oled_levels), offset 0, one page
+static int mp3_oled_mmap(struct file *file, struct vm_area_struct *vma) {
+    if (!oled_levels) return -ENODEV;
+    if (vma->vm_pgoff || vma->vm_end - vma->vm_start > PAGE_SIZE) return -EINVAL;
+
+    return remap_pfn_range(vma, vma->vm_start, virt_to_phys(oled_levels) >> PAGE_SHIFT,
+                           vma->vm_end - vma->vm_start, vma->vm_page_prot);
+}
+
 static const struct file_operations mp3_oled_fops = {
     .owner = THIS_MODULE,
     .open = mp3_oled_open,
     .release = mp3_oled_release,
     .write = mp3_oled_write,
+    .unlocked_ioctl = mp3_oled_ioctl,
+    .mmap = mp3_oled_mmap,
 };
 
 // ===================================================================
-// == ̹ ʱȭ   - ϼ  ==
+// == debugfs ==
 // ===================================================================
+static int oled_stats_show(struct seq_file *m, void *v) {
+    struct oled_panel *p = m->private;
+    struct oled_stats s;
+    unsigned int rendered, coalesced, secs;
 
-static int __init mp3_oled_init(void) {
-    struct i2c_adapter *adapter;
-    struct i2c_board_info oled_info = {
-        I2C_BOARD_INFO("oled", OLED_I2C_ADDR)
-    };
-    
-    // 1. ĳ ̽ ȣ Ҵ
-    if (alloc_chrdev_region(&dev_num, 0, 1, DRIVER_NAME) < 0) {
-        printk(KERN_ERR "[OLED] Failed to allocate device number.\n");
-        return -1;
-    }
-    // 2. ̽ Ŭ 
-    mp3_class = class_create(CLASS_NAME);
-    if (IS_ERR(mp3_class)) {
-        unregister_chrdev_region(dev_num, 1);
-        return PTR_ERR(mp3_class); 
+    spin_lock(&p->stats_lock);
+    s = p->stats;
+    rendered = p->frames_rendered;
+    spin_unlock(&p->stats_lock);
+    coalesced = READ_ONCE(p->frames_coalesced);
+    secs = max(1u, jiffies_to_msecs(jiffies - s.loaded) / 1000);
+
+    seq_printf(m, "panel:             %s\n", p->geo->name);
+    seq_printf(m, "frames_rendered:   %u\n", rendered);
+    seq_printf(m, "frames_coalesced:  %u\n", coalesced);
+    seq_printf(m, "frames_sent:       %u\n", s.frames_sent);
+    seq_printf(m, "frames_dropped:    %u\n", s.frames_dropped);
+    seq_printf(m, "fps:               %u (last second), %u.%02u (average)\n",
+               s.fps, s.frames_sent / secs, s.frames_sent % secs * 100 / secs);
+    seq_printf(m, "render_us:         last %llu, max %llu, avg %llu\n",
+               s.render_ns_last / 1000, s.render_ns_max / 1000,
+               rendered ? div_u64(s.render_ns_total, rendered) / 1000 : 0);
+    seq_printf(m, "text_runs:         %u hits, %u misses, %u atlas glyphs\n",
+               READ_ONCE(p->run_hits), READ_ONCE(p->run_misses), oled_nglyphs);
+    seq_printf(m, "flushes:           %u (%u failed)\n", s.flushes, s.flush_errors);
+    seq_printf(m, "i2c_us:            last %llu, max %llu, avg %llu\n",
+               s.i2c_ns_last / 1000, s.i2c_ns_max / 1000,
+               s.flushes ? div_u64(s.i2c_ns_total, s.flushes) / 1000 : 0);
+    seq_printf(m, "bytes_per_flush:   last %u, max %u, avg %llu\n",
+               s.bytes_last, s.bytes_max, s.flushes ? div_u64(s.bytes_total, s.flushes) : 0);
+    seq_printf(m, "i2c_busy_permille: %llu (budget %u)\n",
+               div_u64(s.i2c_ns_total, (u64)secs * 1000000), READ_ONCE(bus_budget));
+    seq_printf(m, "bus:               %u kHz, %u transfers, %u flushes throttled\n",
+               p->bus_hz / 1000, s.chunks, s.throttled);
+    // Average over the load time, and the rate the bus reached while our transfers ran
+    seq_printf(m, "throughput:        %llu bytes/s, %llu kbit/s while sending\n",
+               div_u64(s.bytes_total, secs),
+               s.i2c_ns_total ? div64_u64(s.bytes_total * 9 * 1000000, s.i2c_ns_total) : 0);
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(oled_stats);
+
+// ===================================================================
+// == I2C ̹ (Device Tree) ==
+// ===================================================================
+static int oled_probe(struct i2c_client *client) {
+    struct device *dev = &client->dev;
+    struct i2c_timings t = { .bus_freq_hz = I2C_MAX_STANDARD_MODE_FREQ };
+    struct oled_panel *p;
+    int id, ret;
+
+    // Freed by the last kref_put: open files keep the panel past remove()
+    p = kzalloc(sizeof(*p), GFP_KERNEL);
+    if (!p) return -ENOMEM;
+    kref_init(&p->ref);
+
+    p->client = client;
+    p->geo = of_device_get_match_data(dev);
+    if (!p->geo) p->geo = &oled_geo_128x64;
+
+    // Transfer buffers used by every flush and command batch
+    p->xfer_buf = devm_kmalloc(dev, OLED_XFER_SIZE + OLED_CMD_MAX + 1, GFP_KERNEL);
+    if (!p->xfer_buf) {
+        ret = -ENOMEM;
+        goto err_free;
     }
-    // 3. ̽  
-    if (device_create(mp3_class, NULL, dev_num, NULL, DEVICE_NAME) == NULL) {
-        class_destroy(mp3_class);
-        unregister_chrdev_region(dev_num, 1);
-        return -1;
+    p->cmd_buf = p->xfer_buf + OLED_XFER_SIZE;
+
+    // The adapter's clock-frequency (100 kHz if it has none); only used to cost flushes
+    if (client->adapter->dev.parent) i2c_parse_fw_timings(client->adapter->dev.parent, &t, true);
+    p->bus_hz = t.bus_freq_hz;
+
+    p->back = &p->frames[0];
+    p->front = &p->frames[1];
+    memcpy(p->widgets, p->geo->layout, sizeof(p->widgets));
+    for (id = 0; id < OLED_W_COUNT; id++) p->widgets[id].dirty = true;
+    spin_lock_init(&p->frame_lock);
+    spin_lock_init(&p->pending_lock);
+    spin_lock_init(&p->stats_lock);
+    mutex_init(&p->lock);
+    atomic_set(&p->fb_users, 0);
+    INIT_DELAYED_WORK(&p->render_work, oled_render_work_fn);
+    INIT_DELAYED_WORK(&p->flush_work, oled_flush_work_fn);
+    INIT_WORK(&p->spectrum_work, oled_spectrum_work_fn);
+    hrtimer_init(&p->spectrum_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    p->spectrum_timer.function = oled_spectrum_timer_fn;
+    p->stats.loaded = jiffies;
+    p->stats.fps_since = jiffies;
+
+    //  ȣ ã /dev/oled (ù г), /dev/oled1, ...  
+    spin_lock(&oled_panels_lock);
+    for (id = 0; id < OLED_MAX_PANELS && oled_panels[id]; id++);
+    if (id < OLED_MAX_PANELS) oled_panels[id] = p;
+    spin_unlock(&oled_panels_lock);
+    if (id == OLED_MAX_PANELS) {
+        ret = -EBUSY;
+        goto err_free;
     }
-    // 4. ĳ ̽ ʱȭ  
-    cdev_init(&mp3_cdev, &mp3_oled_fops);
-    if (cdev_add(&mp3_cdev, dev_num, 1) < 0) {
-        device_destroy(mp3_class, dev_num);
-        class_destroy(mp3_class);
-        unregister_chrdev_region(dev_num, 1);
-        return -1;
+    p->id = id;
+
+    p->cdev = cdev_alloc();
+    if (!p->cdev) {
+        ret = -ENOMEM;
+        goto err_slot;
     }
+    p->cdev->ops = &mp3_oled_fops;
+    p->cdev->owner = THIS_MODULE;
+    ret = cdev_add(p->cdev, MKDEV(MAJOR(dev_num), id), 1);
+    if (ret) goto err_cdev;
 
-    // 5. I2C ġ 
-    adapter = i2c_get_adapter(I2C_BUS_NUMBER);
-    if (!adapter) {
-        printk(KERN_ERR "[OLED] Cannot get I2C adapter %d\n", I2C_BUS_NUMBER);
-        //  ߻  ߴ ĳ ̽ 
-        cdev_del(&mp3_cdev);
-        device_destroy(mp3_class, dev_num);
-        class_destroy(mp3_class);
-        unregister_chrdev_region(dev_num, 1);
-        return -ENODEV;
+    if (id) {
+        p->dev = device_create(mp3_class, dev, MKDEV(MAJOR(dev_num), id), p, "%s%d", DEVICE_NAME, id);
+    } else {
+        p->dev = device_create(mp3_class, dev, MKDEV(MAJOR(dev_num), id), p, DEVICE_NAME);
+    }
+    if (IS_ERR(p->dev)) {
+        ret = PTR_ERR(p->dev);
+        goto err_cdev;
     }
 
-    oled_client = i2c_new_client_device(adapter, &oled_info);
-    i2c_put_adapter(adapter);
+    // OLED Ʈѷ ʱȭ
+    oled_init_sequence(p);
+    oled_load_glyphs(dev);
 
-    if (!oled_client) {
-        printk(KERN_ERR "[OLED] Cannot create I2C client device at address 0x%x\n", oled_info.addr);
-        //  ߻  ߴ ĳ ̽ 
-        cdev_del(&mp3_cdev);
-        device_destroy(mp3_class, dev_num);
-        class_destroy(mp3_class);
-        unregister_chrdev_region(dev_num, 1);
-        return -ENODEV;
+    // The framebuffer is optional; /dev/oled keeps working without it
+    if (oled_fb_register(p)) {
+        dev_warn(dev, "Framebuffer not available, only /dev/%s is\n", dev_name(p->dev));
     }
-    
-    // 6. OLED Ʈѷ ʱȭ
-    oled_init_sequence();
 
-    // 7.  ε  ⺻ ȭ 
+    // debugfs is for tuning only; failures are not an error
+    p->debugfs = debugfs_create_dir(dev_name(dev), oled_debugfs);
+    debugfs_create_file("stats", 0444, p->debugfs, p, &oled_stats_fops);
+
+    i2c_set_clientdata(client, p);
+
+    // ⺻ ȭ 
     struct mp3_ui_data initial_data = {
         .volume = 0, .track_current = 0, .track_total = 0,
         .current_time = "00:00", .playback_time = "00:00", .total_time = "00:00",
         .song_title = "Initializing..."
     };
-    update_display(&initial_data);
+    oled_queue_frame(p, &initial_data);
 
-    printk(KERN_INFO "[OLED] Driver loaded successfully. Device created at /dev/%s\n", DEVICE_NAME);
+    dev_info(dev, "%s panel at /dev/%s, I2C %u kHz\n", p->geo->name, dev_name(p->dev), p->bus_hz / 1000);
+    if (p->bus_hz < I2C_MAX_FAST_MODE_FREQ) {
+        // A full frame takes ~90 ms at 100 kHz; the SSD1306 and SH1106 are specified for 400 kHz
+        dev_info(dev, "Standard mode bus, set clock-frequency = <400000> on the adapter for Fast-mode\n");
+    }
     return 0;
+
+err_cdev:
+    cdev_del(p->cdev);
+err_slot:
+    spin_lock(&oled_panels_lock);
+    oled_panels[id] = NULL;
+    spin_unlock(&oled_panels_lock);
+    // A spectrum update may have queued a frame in the meantime
+    cancel_delayed_work_sync(&p->render_work);
+    cancel_delayed_work_sync(&p->flush_work);
+err_free:
+    kref_put(&p->ref, oled_panel_free);
+    return ret;
 }
 
-static void __exit mp3_oled_exit(void) {
-    //    ȭ 
-    oled_send_cmd(0xAE);
+static void oled_remove(struct i2c_client *client) {
+    struct oled_panel *p = i2c_get_clientdata(client);
 
-    if(oled_client) i2c_unregister_device(oled_client);
+    // No new opens and no new spectrum updates reach the panel after this
+    spin_lock(&oled_panels_lock);
+    oled_panels[p->id] = NULL;
+    spin_unlock(&oled_panels_lock);
+    device_destroy(mp3_class, MKDEV(MAJOR(dev_num), p->id));
+    cdev_del(p->cdev);
+
+    // Files still open keep writing into p->next, but nothing gets scheduled any more
+    mutex_lock(&p->lock);
+    spin_lock(&p->pending_lock);
+    p->removing = true;
+    spin_unlock(&p->pending_lock);
+    mutex_unlock(&p->lock);
+
+    debugfs_remove_recursive(p->debugfs);
+    oled_fb_unregister(p);
+    // The renderer is the one that starts the spectrum timer, so it goes first
+    cancel_delayed_work_sync(&p->render_work);
+    WRITE_ONCE(p->spectrum_running, false);
+    hrtimer_cancel(&p->spectrum_timer);
+    cancel_work_sync(&p->spectrum_work);
+    // Also stops the marquee columns, which requeue the same work
+    cancel_delayed_work_sync(&p->flush_work);
+
+    // ũ ߰ ȭ 
+    if (p->geo->hw_scroll) oled_send_cmd(p, 0x2E);
+    oled_send_cmd(p, 0xAE);
+
+    dev_info(&client->dev, "Panel removed (%u frames rendered, %u coalesced).\n",
+             p->frames_rendered, p->frames_coalesced);
+    kref_put(&p->ref, oled_panel_free);
+}
+
+// Each compatible fixes the controller and the panel size
+static const struct of_device_id oled_of_match[] = {
+    { .compatible = "oled-ssd1306", .data = &oled_geo_128x64 },
+    { .compatible = "oled-ssd1306-128x32", .data = &oled_geo_128x32 },
+    { .compatible = "oled-sh1106", .data = &oled_geo_sh1106 },
+    {}
+};
+MODULE_DEVICE_TABLE(of, oled_of_match);
 
-    cdev_del(&mp3_cdev);
-    device_destroy(mp3_class, dev_num);
+static struct i2c_driver oled_i2c_driver = {
+    .driver = { .name = DRIVER_NAME, .of_match_table = oled_of_match },
+    .probe = oled_probe,
+    .remove = oled_remove,
+};
+
+// ===================================================================
+// == ̹ ʱȭ   - ϼ  ==
+// ===================================================================
+
+static int __init mp3_oled_init(void) {
+    int ret;
+
+    // 1. ĳ ̽ ȣ Ҵ (гθ ϳ)
+    ret = alloc_chrdev_region(&dev_num, 0, OLED_MAX_PANELS, DRIVER_NAME);
+    if (ret < 0) {
+        printk(KERN_ERR "[OLED] Failed to allocate device number.\n");
+        return ret;
+    }
+    // 2. ̽ Ŭ 
+    mp3_class = class_create(CLASS_NAME);
+    if (IS_ERR(mp3_class)) {
+        unregister_chrdev_region(dev_num, OLED_MAX_PANELS);
+        return PTR_ERR(mp3_class);
+    }
+
+    // 3.  г Բ  Ʈ  
+    oled_levels = (struct oled_levels *)get_zeroed_page(GFP_KERNEL);
+    if (!oled_levels) {
+        class_destroy(mp3_class);
+        unregister_chrdev_region(dev_num, OLED_MAX_PANELS);
+        return -ENOMEM;
+    }
+
+    oled_debugfs = debugfs_create_dir(DRIVER_NAME, NULL);
+    oled_digits_init();
+
+    // 4. I2C ̹ , г Device Tree  probe ȴ
+    ret = i2c_add_driver(&oled_i2c_driver);
+    if (ret) {
+        printk(KERN_ERR "[OLED] Failed to register I2C driver: %d\n", ret);
+        debugfs_remove_recursive(oled_debugfs);
+        free_page((unsigned long)oled_levels);
+        class_destroy(mp3_class);
+        unregister_chrdev_region(dev_num, OLED_MAX_PANELS);
+        return ret;
+    }
+
+    printk(KERN_INFO "[OLED] Driver loaded successfully.\n");
+    return 0;
+}
+
+static void __exit mp3_oled_exit(void) {
+    i2c_del_driver(&oled_i2c_driver);
+    release_firmware(oled_glyph_fw);
+    debugfs_remove_recursive(oled_debugfs);
+    free_page((unsigned long)oled_levels);
     class_destroy(mp3_class);
-    unregister_chrdev_region(dev_num, 1);
+    unregister_chrdev_region(dev_num, OLED_MAX_PANELS);
     printk(KERN_INFO "[OLED] Driver unloaded.\n");
 }
 
@@ -379,103 +2096,4 @@ module_exit(mp3_oled_exit);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Your Name");
-MODULE_DESCRIPTION("MP3 Player UI Driver for 128x64 I2C OLED (Completed)");
-
-// Ʈ  ( )
-const unsigned char font5x7[] = {
-	0x00, 0x00, 0x00, 0x00, 0x00, /* Espace	0x20 */
-	0x00, 0x00, 0x4f, 0x00, 0x00, /* ! */
-	0x00, 0x07, 0x00, 0x07, 0x00, /* " */
-	0x14, 0x7f, 0x14, 0x7f, 0x14, /* # */
-	0x24, 0x2a, 0x7f, 0x2a, 0x12, /* $ */
-	0x23, 0x13, 0x08, 0x64, 0x62, /* % */
-	0x36, 0x49, 0x55, 0x22, 0x50, /* & */
-	0x00, 0x05, 0x03, 0x00, 0x00, /* ' */
-	0x00, 0x1c, 0x22, 0x41, 0x00, /* ( */
-	0x00, 0x41, 0x22, 0x1c, 0x00, /* ) */
-	0x08, 0x2a, 0x1c, 0x2a, 0x08, /* * */
-	0x08, 0x08, 0x3e, 0x08, 0x08, /* + */
-	0x00, 0x50, 0x30, 0x00, 0x00, /* , */
-	0x08, 0x08, 0x08, 0x08, 0x08, /* - */
-	0x00, 0x60, 0x60, 0x00, 0x00, /* . */
-	0x20, 0x10, 0x08, 0x04, 0x02, /* / */
-	0x3e, 0x51, 0x49, 0x45, 0x3e, /* 0 */
-	0x00, 0x42, 0x7f, 0x40, 0x00, /* 1 */
-	0x42, 0x61, 0x51, 0x49, 0x46, /* 2 */
-	0x21, 0x41, 0x45, 0x4b, 0x31, /* 3 */
-	0x18, 0x14, 0x12, 0x7f, 0x10, /* 4 */
-	0x27, 0x45, 0x45, 0x45, 0x39, /* 5 */
-	0x3c, 0x4a, 0x49, 0x49, 0x30, /* 6 */
-	0x01, 0x71, 0x09, 0x05, 0x03, /* 7 */
-	0x36, 0x49, 0x49, 0x49, 0x36, /* 8 */
-	0x06, 0x49, 0x49, 0x29, 0x1e, /* 9 */
-	0x00, 0x36, 0x36, 0x00, 0x00, /* : */
-	0x00, 0x56, 0x36, 0x00, 0x00, /* ; */
-	0x00, 0x08, 0x14, 0x22, 0x41, /* < */
-	0x14, 0x14, 0x14, 0x14, 0x14, /* = */
-	0x41, 0x22, 0x14, 0x08, 0x00, /* > */
-	0x02, 0x01, 0x51, 0x09, 0x06, /* ? */
-	0x32, 0x49, 0x79, 0x41, 0x3e, /* @ */
-	0x7e, 0x11, 0x11, 0x11, 0x7e, /* A */
-	0x7f, 0x49, 0x49, 0x49, 0x36, /* B */
-	0x3e, 0x41, 0x41, 0x41, 0x22, /* C */
-	0x7f, 0x41, 0x41, 0x22, 0x1c, /* D */
-	0x7f, 0x49, 0x49, 0x49, 0x41, /* E */
-	0x7f, 0x09, 0x09, 0x01, 0x01, /* F */
-	0x3e, 0x41, 0x41, 0x51, 0x32, /* G */
-	0x7f, 0x08, 0x08, 0x08, 0x7f, /* H */
-	0x00, 0x41, 0x7f, 0x41, 0x00, /* I */
-	0x20, 0x40, 0x41, 0x3f, 0x01, /* J */
-	0x7f, 0x08, 0x14, 0x22, 0x41, /* K */
-	0x7f, 0x40, 0x40, 0x40, 0x40, /* L */
-	0x7f, 0x02, 0x04, 0x02, 0x7f, /* M */
-	0x7f, 0x04, 0x08, 0x10, 0x7f, /* N */
-	0x3e, 0x41, 0x41, 0x41, 0x3e, /* O */
-	0x7f, 0x09, 0x09, 0x09, 0x06, /* P */
-	0x3e, 0x41, 0x51, 0x21, 0x5e, /* Q */
-	0x7f, 0x09, 0x19, 0x29, 0x46, /* R */
-	0x46, 0x49, 0x49, 0x49, 0x31, /* S */
-	0x01, 0x01, 0x7f, 0x01, 0x01, /* T */
-	0x3f, 0x40, 0x40, 0x40, 0x3f, /* U */
-	0x1f, 0x20, 0x40, 0x20, 0x1f, /* V */
-	0x3f, 0x40, 0x38, 0x40, 0x3f, /* W */
-	0x63, 0x14, 0x08, 0x14, 0x63, /* X */
-	0x03, 0x04, 0x78, 0x04, 0x03, /* Y */
-	0x61, 0x51, 0x49, 0x45, 0x43, /* Z */
-	0x00, 0x00, 0x7f, 0x41, 0x41, /* [ */
-	0x02, 0x04, 0x08, 0x10, 0x20, /* \ */
-	0x41, 0x41, 0x7f, 0x00, 0x00, /* ] */
-	0x04, 0x02, 0x01, 0x02, 0x04, /* ^ */
-	0x40, 0x40, 0x40, 0x40, 0x40, /* _ */
-	0x00, 0x01, 0x02, 0x04, 0x00, /* ` */
-	0x20, 0x54, 0x54, 0x54, 0x78, /* a */
-	0x7f, 0x48, 0x44, 0x44, 0x38, /* b */
-	0x38, 0x44, 0x44, 0x44, 0x20, /* c */
-	0x38, 0x44, 0x44, 0x48, 0x7f, /* d */
-	0x38, 0x54, 0x54, 0x54, 0x18, /* e */
-	0x08, 0x7e, 0x09, 0x01, 0x02, /* f */
-	0x0C, 0x52, 0x52, 0x52, 0x3E, /* g */
-	0x7f, 0x08, 0x04, 0x04, 0x78, /* h */
-	0x00, 0x44, 0x7d, 0x40, 0x00, /* i */
-	0x20, 0x40, 0x44, 0x3d, 0x00, /* j */
-	0x00, 0x7f, 0x10, 0x28, 0x44, /* k */
-	0x00, 0x41, 0x7f, 0x40, 0x00, /* l */
-	0x7c, 0x04, 0x18, 0x04, 0x78, /* m */
-	0x7c, 0x08, 0x04, 0x04, 0x78, /* n */
-	0x38, 0x44, 0x44, 0x44, 0x38, /* o */
-	0x7c, 0x14, 0x14, 0x14, 0x08, /* p */
-	0x08, 0x14, 0x14, 0x18, 0x7c, /* q */
-	0x7c, 0x08, 0x04, 0x04, 0x08, /* r */
-	0x48, 0x54, 0x54, 0x54, 0x20, /* s */
-	0x04, 0x3f, 0x44, 0x40, 0x20, /* t */
-	0x3c, 0x40, 0x40, 0x20, 0x7c, /* u */
-	0x1c, 0x20, 0x40, 0x20, 0x1c, /* v */
-	0x3c, 0x40, 0x30, 0x40, 0x3c, /* w */
-	0x44, 0x28, 0x10, 0x28, 0x44, /* x */
-	0x0c, 0x50, 0x50, 0x50, 0x3c, /* y */
-	0x44, 0x64, 0x54, 0x4c, 0x44, /* z */
-	0x00, 0x08, 0x36, 0x41, 0x00, /* { */
-	0x00, 0x00, 0x7f, 0x00, 0x00, /* | */
-	0x00, 0x41, 0x36, 0x08, 0x00, /* } */
-	0x08, 0x04, 0x08, 0x10, 0x08, /* ~ */
-};
\ No newline at end of file
+MODULE_DESCRIPTION("MP3 Player UI Driver for SSD1306/SH1106 I2C OLED panels");
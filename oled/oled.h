@@ -1,6 +1,8 @@
 #ifndef OLED_H
 #define OLED_H
 
+#include <linux/ioctl.h>
+
 // UI ͸  ü
 struct mp3_ui_data {
     // 1)  (0~15)
@@ -26,4 +28,38 @@ struct mp3_ui_data {
     char total_time[6];
 };
 
+//  ׸ ٲٴ ioctl, ش ׸ ׷  ٽ ׸
+#define OLED_TITLE_MAX        128   // ȭ  Ѵ  ߸
+#define OLED_SPECTRUM_BANDS   32
+
+struct oled_track {
+    unsigned int current;
+    unsigned int total;
+};
+
+#define OLED_IOCTL_BASE 'o'
+#define OLED_SET_VOLUME          _IOW(OLED_IOCTL_BASE, 1, unsigned char)        // 0~15
+#define OLED_SET_CLOCK           _IOW(OLED_IOCTL_BASE, 2, char[6])              // "HH:MM"
+#define OLED_SET_TRACK           _IOW(OLED_IOCTL_BASE, 3, struct oled_track)
+#define OLED_SET_PLAYBACK_TIME   _IOW(OLED_IOCTL_BASE, 4, char[6])              // "MM:SS"
+#define OLED_SET_TOTAL_TIME      _IOW(OLED_IOCTL_BASE, 5, char[6])              // "MM:SS"
+#define OLED_SET_TITLE           _IOW(OLED_IOCTL_BASE, 6, char[OLED_TITLE_MAX])
+#define OLED_SET_SPECTRUM_RUN    _IOW(OLED_IOCTL_BASE, 7, int)                  // spectrum_run_stop   ǹ
+#define OLED_SET_SPECTRUM_LEVELS _IOW(OLED_IOCTL_BASE, 8, unsigned char[OLED_SPECTRUM_BANDS]) //   0~15,    
+
+/*
+ * Ʈ   : /dev/oled  O_RDWR   offset 0    mmap.
+ * levels    seq  1 Ű ̹  ӿ ݿѴ ( ).
+ * ڴ ϳ̾ Ѵ: seq   Ƿ mmap   α׷
+ * OLED_SET_SPECTRUM_LEVELS Ǵ oled_spectrum_update()  Բ    levels  δ.
+ */
+struct oled_levels {
+    unsigned int seq;
+    unsigned char levels[OLED_SPECTRUM_BANDS];  // 0~15
+};
+
+#ifdef __KERNEL__
+int oled_spectrum_update(const unsigned char *levels, int n);
+#endif
+
 #endif // OLED_H
\ No newline at end of file
@@ -0,0 +1,221 @@
+/*
+ * Page layout drawing primitives of the OLED driver and its 5x7 font.
+ *
+ * Shared by oled.c and the host benchmark in test/oled_bench.c, so both
+ * draw with the same code. A frame is SCREEN_WIDTH bytes per page, one
+ * byte is 8 vertical pixels, LSB on top; every primitive works on those
+ * bytes directly, a masked byte per column and page instead of a bounds
+ * check and read-modify-write per pixel. height is the panel height in
+ * pixels, a multiple of 8.
+ *
+ * OLED_DRAW_COUNT(n) is called with the number of bytes every primitive
+ * touches; the benchmark defines it before the include to count them.
+ */
+#ifndef _OLED_DRAW_H
+#define _OLED_DRAW_H
+
+#ifdef __KERNEL__
+#include <linux/compiler.h>
+#include <linux/minmax.h>
+#include <linux/types.h>
+#else
+#include <stdint.h>
+typedef uint16_t u16;
+#ifndef __always_inline
+#define __always_inline inline __attribute__((always_inline))
+#endif
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef OLED_DRAW_COUNT
+#define OLED_DRAW_COUNT(n) do { } while (0)
+#endif
+
+#define SCREEN_WIDTH    128   // visible columns of every supported panel, also the frame stride
+
+// ORs 8 vertical pixels (LSB on top) in at x, y; split over two bytes when they straddle a page boundary
+static __always_inline void oled_draw_column(unsigned char *pix, int height, int x, int y, unsigned char bits) {
+    int page, shift;
+
+    if (x < 0 || x >= SCREEN_WIDTH || y <= -8 || y >= height) return;
+    if (y < 0) {
+        bits >>= -y;
+        y = 0;
+    }
+
+    page = y / 8;
+    shift = y % 8;
+    pix[page * SCREEN_WIDTH + x] |= bits << shift;
+    OLED_DRAW_COUNT(1);
+    if (shift && page + 1 < height / 8) {
+        pix[(page + 1) * SCREEN_WIDTH + x] |= bits >> (8 - shift);
+        OLED_DRAW_COUNT(1);
+    }
+}
+
+// Sets (color = 1) or clears (color = 0) a rectangle, one mask per page
+static __always_inline void oled_draw_span(unsigned char *pix, int height, int x, int y, int w, int h, int color) {
+    int page, top, bot, i;
+    unsigned char mask, *row;
+
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > SCREEN_WIDTH) w = SCREEN_WIDTH - x;
+    if (y + h > height) h = height - y;
+    if (w <= 0 || h <= 0) return;
+
+    for (page = y / 8; page <= (y + h - 1) / 8; page++) {
+        top = max(y, page * 8) - page * 8;
+        bot = min(y + h, page * 8 + 8) - page * 8;
+        mask = (0xFF << top) & (0xFF >> (8 - bot));
+        row = &pix[page * SCREEN_WIDTH + x];
+        if (color) {
+            for (i = 0; i < w; i++) row[i] |= mask;
+        } else {
+            for (i = 0; i < w; i++) row[i] &= ~mask;
+        }
+        OLED_DRAW_COUNT(w);
+    }
+}
+
+// A filled rectangle, or its one pixel outline
+static __always_inline void oled_draw_box(unsigned char *pix, int height, int x, int y, int w, int h, int fill) {
+    if (fill || w <= 2 || h <= 2) {
+        oled_draw_span(pix, height, x, y, w, h, 1);
+        return;
+    }
+    oled_draw_span(pix, height, x, y, w, 1, 1);
+    oled_draw_span(pix, height, x, y + h - 1, w, 1, 1);
+    oled_draw_span(pix, height, x, y + 1, 1, h - 2, 1);
+    oled_draw_span(pix, height, x + w - 1, y + 1, 1, h - 2, 1);
+}
+
+/*
+ * ORs columns pre-shifted by y & 7 in at x, y: the low byte goes to the
+ * page y is on, the high byte to the one below.
+ */
+static __always_inline void oled_draw_run(unsigned char *pix, int height, int x, int y, const u16 *cols, int w) {
+    int page = y >> 3, i;   // y may be negative; page -1 is skipped
+    unsigned char *row;
+
+    if (x < 0) {
+        cols -= x;
+        w += x;
+        x = 0;
+    }
+    if (x + w > SCREEN_WIDTH) w = SCREEN_WIDTH - x;
+    if (w <= 0) return;
+
+    if (page >= 0 && page < height / 8) {
+        row = &pix[page * SCREEN_WIDTH + x];
+        for (i = 0; i < w; i++) row[i] |= cols[i];
+        OLED_DRAW_COUNT(w);
+    }
+    if ((y & 7) && page + 1 >= 0 && page + 1 < height / 8) {
+        row = &pix[(page + 1) * SCREEN_WIDTH + x];
+        for (i = 0; i < w; i++) row[i] |= cols[i] >> 8;
+        OLED_DRAW_COUNT(w);
+    }
+}
+
+// 5x7 ASCII font, 0x20..0x7E, 5 columns per character in page layout
+static const unsigned char font5x7[] = {
+	0x00, 0x00, 0x00, 0x00, 0x00, /* Espace	0x20 */
+	0x00, 0x00, 0x4f, 0x00, 0x00, /* ! */
+	0x00, 0x07, 0x00, 0x07, 0x00, /* " */
+	0x14, 0x7f, 0x14, 0x7f, 0x14, /* # */
+	0x24, 0x2a, 0x7f, 0x2a, 0x12, /* $ */
+	0x23, 0x13, 0x08, 0x64, 0x62, /* % */
+	0x36, 0x49, 0x55, 0x22, 0x50, /* & */
+	0x00, 0x05, 0x03, 0x00, 0x00, /* ' */
+	0x00, 0x1c, 0x22, 0x41, 0x00, /* ( */
+	0x00, 0x41, 0x22, 0x1c, 0x00, /* ) */
+	0x08, 0x2a, 0x1c, 0x2a, 0x08, /* * */
+	0x08, 0x08, 0x3e, 0x08, 0x08, /* + */
+	0x00, 0x50, 0x30, 0x00, 0x00, /* , */
+	0x08, 0x08, 0x08, 0x08, 0x08, /* - */
+	0x00, 0x60, 0x60, 0x00, 0x00, /* . */
+	0x20, 0x10, 0x08, 0x04, 0x02, /* / */
+	0x3e, 0x51, 0x49, 0x45, 0x3e, /* 0 */
+	0x00, 0x42, 0x7f, 0x40, 0x00, /* 1 */
+	0x42, 0x61, 0x51, 0x49, 0x46, /* 2 */
+	0x21, 0x41, 0x45, 0x4b, 0x31, /* 3 */
+	0x18, 0x14, 0x12, 0x7f, 0x10, /* 4 */
+	0x27, 0x45, 0x45, 0x45, 0x39, /* 5 */
+	0x3c, 0x4a, 0x49, 0x49, 0x30, /* 6 */
+	0x01, 0x71, 0x09, 0x05, 0x03, /* 7 */
+	0x36, 0x49, 0x49, 0x49, 0x36, /* 8 */
+	0x06, 0x49, 0x49, 0x29, 0x1e, /* 9 */
+	0x00, 0x36, 0x36, 0x00, 0x00, /* : */
+	0x00, 0x56, 0x36, 0x00, 0x00, /* ; */
+	0x00, 0x08, 0x14, 0x22, 0x41, /* < */
+	0x14, 0x14, 0x14, 0x14, 0x14, /* = */
+	0x41, 0x22, 0x14, 0x08, 0x00, /* > */
+	0x02, 0x01, 0x51, 0x09, 0x06, /* ? */
+	0x32, 0x49, 0x79, 0x41, 0x3e, /* @ */
+	0x7e, 0x11, 0x11, 0x11, 0x7e, /* A */
+	0x7f, 0x49, 0x49, 0x49, 0x36, /* B */
+	0x3e, 0x41, 0x41, 0x41, 0x22, /* C */
+	0x7f, 0x41, 0x41, 0x22, 0x1c, /* D */
+	0x7f, 0x49, 0x49, 0x49, 0x41, /* E */
+	0x7f, 0x09, 0x09, 0x01, 0x01, /* F */
+	0x3e, 0x41, 0x41, 0x51, 0x32, /* G */
+	0x7f, 0x08, 0x08, 0x08, 0x7f, /* H */
+	0x00, 0x41, 0x7f, 0x41, 0x00, /* I */
+	0x20, 0x40, 0x41, 0x3f, 0x01, /* J */
+	0x7f, 0x08, 0x14, 0x22, 0x41, /* K */
+	0x7f, 0x40, 0x40, 0x40, 0x40, /* L */
+	0x7f, 0x02, 0x04, 0x02, 0x7f, /* M */
+	0x7f, 0x04, 0x08, 0x10, 0x7f, /* N */
+	0x3e, 0x41, 0x41, 0x41, 0x3e, /* O */
+	0x7f, 0x09, 0x09, 0x09, 0x06, /* P */
+	0x3e, 0x41, 0x51, 0x21, 0x5e, /* Q */
+	0x7f, 0x09, 0x19, 0x29, 0x46, /* R */
+	0x46, 0x49, 0x49, 0x49, 0x31, /* S */
+	0x01, 0x01, 0x7f, 0x01, 0x01, /* T */
+	0x3f, 0x40, 0x40, 0x40, 0x3f, /* U */
+	0x1f, 0x20, 0x40, 0x20, 0x1f, /* V */
+	0x3f, 0x40, 0x38, 0x40, 0x3f, /* W */
+	0x63, 0x14, 0x08, 0x14, 0x63, /* X */
+	0x03, 0x04, 0x78, 0x04, 0x03, /* Y */
+	0x61, 0x51, 0x49, 0x45, 0x43, /* Z */
+	0x00, 0x00, 0x7f, 0x41, 0x41, /* [ */
+	0x02, 0x04, 0x08, 0x10, 0x20, /* \ */
+	0x41, 0x41, 0x7f, 0x00, 0x00, /* ] */
+	0x04, 0x02, 0x01, 0x02, 0x04, /* ^ */
+	0x40, 0x40, 0x40, 0x40, 0x40, /* _ */
+	0x00, 0x01, 0x02, 0x04, 0x00, /* ` */
+	0x20, 0x54, 0x54, 0x54, 0x78, /* a */
+	0x7f, 0x48, 0x44, 0x44, 0x38, /* b */
+	0x38, 0x44, 0x44, 0x44, 0x20, /* c */
+	0x38, 0x44, 0x44, 0x48, 0x7f, /* d */
+	0x38, 0x54, 0x54, 0x54, 0x18, /* e */
+	0x08, 0x7e, 0x09, 0x01, 0x02, /* f */
+	0x0C, 0x52, 0x52, 0x52, 0x3E, /* g */
+	0x7f, 0x08, 0x04, 0x04, 0x78, /* h */
+	0x00, 0x44, 0x7d, 0x40, 0x00, /* i */
+	0x20, 0x40, 0x44, 0x3d, 0x00, /* j */
+	0x00, 0x7f, 0x10, 0x28, 0x44, /* k */
+	0x00, 0x41, 0x7f, 0x40, 0x00, /* l */
+	0x7c, 0x04, 0x18, 0x04, 0x78, /* m */
+	0x7c, 0x08, 0x04, 0x04, 0x78, /* n */
+	0x38, 0x44, 0x44, 0x44, 0x38, /* o */
+	0x7c, 0x14, 0x14, 0x14, 0x08, /* p */
+	0x08, 0x14, 0x14, 0x18, 0x7c, /* q */
+	0x7c, 0x08, 0x04, 0x04, 0x08, /* r */
+	0x48, 0x54, 0x54, 0x54, 0x20, /* s */
+	0x04, 0x3f, 0x44, 0x40, 0x20, /* t */
+	0x3c, 0x40, 0x40, 0x20, 0x7c, /* u */
+	0x1c, 0x20, 0x40, 0x20, 0x1c, /* v */
+	0x3c, 0x40, 0x30, 0x40, 0x3c, /* w */
+	0x44, 0x28, 0x10, 0x28, 0x44, /* x */
+	0x0c, 0x50, 0x50, 0x50, 0x3c, /* y */
+	0x44, 0x64, 0x54, 0x4c, 0x44, /* z */
+	0x00, 0x08, 0x36, 0x41, 0x00, /* { */
+	0x00, 0x00, 0x7f, 0x00, 0x00, /* | */
+	0x00, 0x41, 0x36, 0x08, 0x00, /* } */
+	0x08, 0x04, 0x08, 0x10, 0x08, /* ~ */
+};
+
+#endif
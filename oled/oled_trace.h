@@ -0,0 +1,71 @@
+/*
+ * Tracepoints of the OLED driver, under events/oled/ in tracefs:
+ * oled_render  - one frame drawn into the back buffer
+ * oled_flush   - one I2C transfer to the panel
+ * oled_write   - one mp3_ui_data frame written to /dev/oled
+ */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM oled
+
+#if !defined(_OLED_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _OLED_TRACE_H
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(oled_render,
+    TP_PROTO(unsigned int dirty, u64 duration_ns),
+    TP_ARGS(dirty, duration_ns),
+    TP_STRUCT__entry(
+        __field(unsigned int, dirty)
+        __field(u64, duration_ns)
+    ),
+    TP_fast_assign(
+        __entry->dirty = dirty;
+        __entry->duration_ns = duration_ns;
+    ),
+    TP_printk("dirty=0x%02x duration=%lluns", __entry->dirty, __entry->duration_ns)
+);
+
+TRACE_EVENT(oled_flush,
+    TP_PROTO(int windows, int pixels, int bytes, u64 duration_ns, int ret),
+    TP_ARGS(windows, pixels, bytes, duration_ns, ret),
+    TP_STRUCT__entry(
+        __field(int, windows)
+        __field(int, pixels)
+        __field(int, bytes)
+        __field(u64, duration_ns)
+        __field(int, ret)
+    ),
+    TP_fast_assign(
+        __entry->windows = windows;
+        __entry->pixels = pixels;
+        __entry->bytes = bytes;
+        __entry->duration_ns = duration_ns;
+        __entry->ret = ret;
+    ),
+    TP_printk("windows=%d pixel_bytes=%d bus_bytes=%d duration=%lluns ret=%d",
+              __entry->windows, __entry->pixels, __entry->bytes, __entry->duration_ns, __entry->ret)
+);
+
+TRACE_EVENT(oled_write,
+    TP_PROTO(int volume, const char *title, size_t title_size),
+    TP_ARGS(volume, title, title_size),
+    TP_STRUCT__entry(
+        __field(int, volume)
+        __array(char, title, 32)
+    ),
+    TP_fast_assign(
+        __entry->volume = volume;
+        // title is a fixed-size field that need not be terminated; never read past it
+        strscpy(__entry->title, title, min(sizeof(__entry->title), title_size));
+    ),
+    TP_printk("vol=%d title=%s", __entry->volume, __entry->title)
+);
+
+#endif /* _OLED_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE oled_trace
+#include <trace/define_trace.h>
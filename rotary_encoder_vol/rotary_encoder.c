@@ -1,186 +1,617 @@
 #include <linux/module.h>
 #include <linux/kernel.h>
-#include <linux/gpio.h>
+#include <linux/gpio/consumer.h>
+#include <linux/platform_device.h>
+#include <linux/of.h>
+#include <linux/slab.h>
+#include <linux/list.h>
+#include <linux/kref.h>
 #include <linux/interrupt.h>
 #include <linux/jiffies.h>
 #include <linux/timer.h>
 #include <linux/fs.h>
 #include <linux/cdev.h>
 #include <linux/uaccess.h>
+#include <linux/kfifo.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/input.h>
+#include <linux/device.h>
+#include <linux/hrtimer.h>
+#include "rotary_encoder.h"
 
 #define DEVICE_NAME "rotary_encoder"
+#define CLASS_NAME  "rotary_class"
 
-#define GPIO_S1         512+17
-#define GPIO_S2         512+27
-#define GPIO_KEY        512+22
+#define ROTARY_MAX_DEVICES 4
 
 #define DEBOUNCE_TIME_MS 20
+#define EVENT_FIFO_SIZE  64   // 2의 거듭제곱
+#define COUNTER_MAX      0b1111
+
+/*
+ * 4상 디코더: (이전 상태 << 2 | 현재 상태) 로 찾는 1/4 스텝 방향.
+ * 상태는 (s1 << 1) | s2, 시계 방향은 00 -> 10 -> 11 -> 01 -> 00.
+ * 두 비트가 한꺼번에 바뀐 전이(2)는 중간 상태를 놓친 것이다.
+ */
+static const signed char quad_table[16] = {
+	 0, -1,  1,  2,   // 00 -> 00, 01, 10, 11
+	 1,  0,  2, -1,   // 01 -> 00, 01, 10, 11
+	-1,  2,  0,  1,   // 10 -> 00, 01, 10, 11
+	 2,  1, -1,  0,   // 11 -> 00, 01, 10, 11
+};
 
-static int counter = 0;
-static volatile int key_press_event = 0;
-static int prev_s1 = 0;
-static int prev_s2 = 0;
-
-static struct timer_list debounce_timer;
+static unsigned int steps_per_detent = 4;
+module_param(steps_per_detent, uint, 0644);
+MODULE_PARM_DESC(steps_per_detent, "Quadrature steps per detent: 4 = full step, 2 = half step, 1 = quarter step (default 4)");
+
+static unsigned int accel_ms = 100;
+module_param(accel_ms, uint, 0644);
+MODULE_PARM_DESC(accel_ms, "Detents closer together than this are accelerated, 0 to disable (default 100)");
+
+static unsigned int accel_max = 4;
+module_param(accel_max, uint, 0644);
+MODULE_PARM_DESC(accel_max, "Largest count change per detent when turning fast (default 4)");
+
+static unsigned int click_ms = 300;
+module_param(click_ms, uint, 0644);
+MODULE_PARM_DESC(click_ms, "Time after a release in which another press continues a multi-click (default 300)");
+
+static unsigned int long_press_ms = 800;
+module_param(long_press_ms, uint, 0644);
+MODULE_PARM_DESC(long_press_ms, "Hold time that makes a press a long press (default 800)");
+
+/*
+ * 엔코더 하나. GPIO 와 IRQ 는 probe 에서 Device Tree 로 받아 remove 까지 잡고 있으므로
+ * open() 은 읽는 쪽을 등록하기만 한다.
+ */
+struct rotary_dev {
+    int id;
+    struct kref ref;            // probe 와 열린 파일마다 하나, 마지막 put 이 해제한다
+    bool dead;                  // remove 됐다, event_lock 으로 보호
+    struct device *dev;         // /dev/rotary_encoder, /dev/rotary_encoder1, ...
+    struct cdev *cdev;          // 따로 할당: 열린 파일이 rd 보다 오래 잡고 있을 수 있다
+
+    struct gpio_desc *s1, *s2;
+    struct gpio_desc *key;      // 없어도 된다 (key-gpios 는 선택)
+
+    /*
+     * IRQ 핸들러와 타이머가 이벤트를 넣는다, event_lock 으로 직렬화.
+     * event_lock 은 아래 상태와 readers 목록도 보호한다.
+     */
+    spinlock_t event_lock;
+    wait_queue_head_t event_wait;
+    struct list_head readers;
+
+    int counter;
+    int key_down;               // 디바운스 후의 키 상태
+    int prev_s1, prev_s2;
+    int quarter_steps;          // 마지막 디텐트 이후 누적된 1/4 스텝
+    int last_dir;               // 마지막으로 확실했던 방향, 놓친 상태를 메울 때 쓴다
+    u64 last_detent_ns;
+    unsigned int glitches;
+
+    /*
+     * 같은 이벤트를 input 장치로도 보낸다: REL_DIAL (가속된 스텝 수) 과 KEY_PLAYPAUSE.
+     * /dev/input/eventN 은 여러 프로그램이 동시에 읽을 수 있다.
+     */
+    struct input_dev *input;
+
+    struct timer_list debounce_timer;
+    u64 key_edge_ns;            // 바운스가 시작된 첫 엣지의 시각 = 실제로 누르거나 뗀 시각
+
+    /*
+     * 키 제스처: 누를 때마다 clicks 를 세고, 마지막으로 뗀 뒤 click_ms 동안 다시 누르지 않으면
+     * 한 번/두 번/세 번 클릭으로 보낸다. long_press_ms 이상 누르고 있으면 길게 누름 시작,
+     * 떼면 끝. 두 시간은 모두 엣지 시각부터 재므로 디바운스 지연과 상관없다.
+     */
+    struct hrtimer gesture_timer;
+    int clicks;
+    bool long_press;
+};
 
-static int irq_s1, irq_s2, irq_key;
+/*
+ * open() 마다 하나. 이벤트는 모든 reader 의 FIFO 에 복사되므로 플레이어, UI, 진단 도구가
+ * 같은 엔코더를 동시에 읽어도 서로 이벤트를 빼앗지 않는다. 꺼내는 쪽은 read_lock 으로 직렬화.
+ */
+struct rotary_reader {
+    struct list_head node;
+    struct rotary_dev *rd;
+    DECLARE_KFIFO(fifo, struct rotary_event, EVENT_FIFO_SIZE);
+    struct mutex read_lock;
+    unsigned int dropped;
+};
 
-static void debounce_timer_callback(struct timer_list *t);
-static irqreturn_t irq_handler(int irq, void *dev_id);
-static irqreturn_t key_handler(int irq, void *dev_id);
+static struct rotary_dev *rotary_devs[ROTARY_MAX_DEVICES];
+static DEFINE_SPINLOCK(rotary_devs_lock);
 
 static int my_open(struct inode *inode, struct file *file);
 static int my_release(struct inode *inode, struct file *file);
 static ssize_t my_read(struct file *filp, char __user *buf, size_t len, loff_t *off);
+static __poll_t my_poll(struct file *filp, struct poll_table_struct *wait);
 
 static dev_t dev_num;
-static struct cdev my_cdev;
+static struct class *rotary_class;
 
 static struct file_operations fops = {
 	.owner = THIS_MODULE,
 	.open = my_open,
     .read = my_read,
+    .poll = my_poll,
 	.release = my_release
 };
 
-static ssize_t my_read(struct file *filp, char __user *buf, size_t len, loff_t *off) {
-    char msg[16];
-    int msg_len;
-    int event_to_send;
+// 이벤트 하나를 모든 reader 의 FIFO 에 넣고 기다리는 read()/poll() 을 깨운다, event_lock 을 잡은 상태에서 호출
+static void push_event(struct rotary_dev *rd, u64 ts, unsigned char type, short delta, unsigned char value)
+{
+    struct rotary_reader *r;
+    struct rotary_event ev = {
+        .timestamp_ns = ts,
+        .count = rd->counter,
+        .delta = delta,
+        .type = type,
+        .value = value,
+    };
+
+    // 가득 차면 새 이벤트를 버린다 (그 reader 가 멈춰 있는 경우), 다른 reader 는 영향 없음
+    list_for_each_entry(r, &rd->readers, node) {
+        if (!kfifo_put(&r->fifo, ev)) r->dropped++;
+    }
+    wake_up_interruptible(&rd->event_wait);
 
-    event_to_send = key_press_event;
-    key_press_event = 0;
+    // 키는 evdev 에도 같은 시각으로 (회전은 irq_handler 가 가속 전 디텐트로 보낸다)
+    if (type == ROTARY_EV_KEY) {
+        input_set_timestamp(rd->input, ns_to_ktime(ts));
+        input_report_key(rd->input, KEY_PLAYPAUSE, value);
+        input_sync(rd->input);
+    }
+}
 
-    // 현재 카운트 값을 문자열로 변환
-    msg_len = sprintf(msg, "%d,%d\n", counter, event_to_send);
+/*
+ * struct rotary_event 를 len 에 들어가는 만큼 돌려준다.
+ * 이벤트가 없으면 O_NONBLOCK 이 아닌 한 생길 때까지 잠든다.
+ */
+static ssize_t my_read(struct file *filp, char __user *buf, size_t len, loff_t *off) {
+    struct rotary_reader *r = filp->private_data;
+    unsigned int copied;
+    int ret;
+
+    if (len < sizeof(struct rotary_event)) return -EINVAL;
+
+    if (mutex_lock_interruptible(&r->read_lock)) return -ERESTARTSYS;
+    while (kfifo_is_empty(&r->fifo)) {
+        mutex_unlock(&r->read_lock);
+        // 엔코더가 빠졌으면 더 올 이벤트가 없다
+        if (READ_ONCE(r->rd->dead)) return -ENODEV;
+        if (filp->f_flags & O_NONBLOCK) return -EAGAIN;
+        if (wait_event_interruptible(r->rd->event_wait, !kfifo_is_empty(&r->fifo) || READ_ONCE(r->rd->dead))) return -ERESTARTSYS;
+        if (mutex_lock_interruptible(&r->read_lock)) return -ERESTARTSYS;
+    }
 
-    // 커널 공간의 데이터를 유저 공간으로 복사
-    if (copy_to_user(buf, msg, msg_len)) {
+    // 넣는 쪽은 event_lock, 꺼내는 쪽은 read_lock 으로 하나씩이므로 kfifo 를 그대로 꺼낼 수 있다
+    ret = kfifo_to_user(&r->fifo, buf, len, &copied);
+    mutex_unlock(&r->read_lock);
+    if (ret) {
         pr_err("Rotary: Failed to copy data to user\n");
-        return -EFAULT;
+        return ret;
     }
-
-    *off = msg_len;
-    return msg_len;
+    return copied;
 }
 
-static int my_open(struct inode *inode, struct file *file)
+static __poll_t my_poll(struct file *filp, struct poll_table_struct *wait)
 {
-	int result = 0;
-
-	pr_info("rotary_encoder driver opened.\n");
-
-	// gpio 초기화
-	gpio_request_one(GPIO_S1, GPIOF_IN, "rotary-s1");
-    gpio_request_one(GPIO_S2, GPIOF_IN, "rotary-s2");
-    gpio_request_one(GPIO_KEY, GPIOF_IN, "rotary-key");
+    struct rotary_reader *r = filp->private_data;
 
-	prev_s1 = gpio_get_value(GPIO_S1);
-	prev_s2 = gpio_get_value(GPIO_S2);
-
-	irq_s1 = gpio_to_irq(GPIO_S1);
-	irq_s2 = gpio_to_irq(GPIO_S2);
-	irq_key = gpio_to_irq(GPIO_KEY);
+    poll_wait(filp, &r->rd->event_wait, wait);
+    if (!kfifo_is_empty(&r->fifo)) return EPOLLIN | EPOLLRDNORM;
+    // poll 은 에러 코드를 돌려줄 수 없으므로 read() 가 -ENODEV 를 보게 한다
+    return READ_ONCE(r->rd->dead) ? EPOLLERR | EPOLLHUP : 0;
+}
 
-	timer_setup(&debounce_timer, debounce_timer_callback, 0); // debounce_timer가 20ms가 되면 콜백함수 실행
+static void rotary_free(struct kref *ref)
+{
+    kfree(container_of(ref, struct rotary_dev, ref));
+}
 
-	result = request_threaded_irq(irq_s1, NULL, irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING | IRQF_ONESHOT, "rotary-s1-irq", NULL);
-    result |= request_threaded_irq(irq_s2, NULL, irq_handler, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING | IRQF_ONESHOT, "rotary-s2-irq", NULL);
-    result |= request_threaded_irq(irq_key, NULL, key_handler, IRQF_TRIGGER_FALLING | IRQF_ONESHOT, "rotary-key-irq", NULL);
+// 열린 minor 번호의 엔코더에 reader 를 하나 붙인다, 하드웨어는 건드리지 않는다
+static int my_open(struct inode *inode, struct file *file)
+{
+    struct rotary_dev *rd;
+    struct rotary_reader *r;
+
+    // remove 가 시작된 엔코더는 목록에 없다
+    spin_lock(&rotary_devs_lock);
+    rd = rotary_devs[iminor(inode)];
+    if (rd) kref_get(&rd->ref);
+    spin_unlock(&rotary_devs_lock);
+    if (!rd) return -ENODEV;
+
+    r = kzalloc(sizeof(*r), GFP_KERNEL);
+    if (!r) {
+        kref_put(&rd->ref, rotary_free);
+        return -ENOMEM;
+    }
 
-	if(result)
-	{
-		pr_err("rotary_encoder driver : failed to request IRQ\n");
-		return result;
-	}
+    r->rd = rd;
+    INIT_KFIFO(r->fifo);
+    mutex_init(&r->read_lock);
 
-	pr_info("rotary_encoder driver : opened successfully.\n");
+    spin_lock_irq(&rd->event_lock);
+    list_add_tail(&r->node, &rd->readers);
+    spin_unlock_irq(&rd->event_lock);
 
-	return 0;
+    file->private_data = r;
+    return 0;
 }
 
 static int my_release(struct inode *inode, struct file *file)
 {
-	pr_info("rotary_encoder driver : device closed\n");
+    struct rotary_reader *r = file->private_data;
+    struct rotary_dev *rd = r->rd;
 
-	del_timer_sync(&debounce_timer);
-	free_irq(irq_s1, NULL);
-	free_irq(irq_s2, NULL);
-	free_irq(irq_key, NULL);
+    spin_lock_irq(&rd->event_lock);
+    list_del(&r->node);
+    spin_unlock_irq(&rd->event_lock);
 
-	gpio_free(GPIO_S1);
-	gpio_free(GPIO_S2);
-	gpio_free(GPIO_KEY);
+    // rd->dev 는 remove 뒤에 없을 수 있다
+    if (r->dropped) pr_info("rotary_encoder%d: reader closed, %u events dropped\n", rd->id, r->dropped);
+    kfree(r);
+    kref_put(&rd->ref, rotary_free);
+    return 0;
+}
+
+// 제스처 창이 끝났다: 아직 누르고 있으면 길게 누름, 떼어져 있으면 모은 클릭 수
+static enum hrtimer_restart gesture_timer_callback(struct hrtimer *t)
+{
+   struct rotary_dev *rd = container_of(t, struct rotary_dev, gesture_timer);
+   unsigned long flags;
+   u64 now = ktime_get_ns();
+
+   spin_lock_irqsave(&rd->event_lock, flags);
+   if (rd->key_down) {
+       rd->long_press = true;
+       push_event(rd, now, ROTARY_EV_GESTURE, 0, ROTARY_GESTURE_LONG_START);
+   } else if (rd->clicks) {
+       push_event(rd, now, ROTARY_EV_GESTURE, 0, min(rd->clicks, ROTARY_GESTURE_TRIPLE));
+   }
+   rd->clicks = 0;
+   spin_unlock_irqrestore(&rd->event_lock, flags);
+   return HRTIMER_NORESTART;
+}
 
-	return 0;
+// 디바운스가 끝난 키 엣지로 제스처 상태를 진행한다, event_lock 을 잡은 상태에서 호출
+static void gesture_edge(struct rotary_dev *rd, u64 edge, int down)
+{
+   unsigned int ms;
+
+   if (down) {
+       rd->clicks++;
+       ms = READ_ONCE(long_press_ms);
+   } else if (rd->long_press) {
+       // 길게 누른 것은 클릭으로 세지 않는다
+       rd->long_press = false;
+       hrtimer_try_to_cancel(&rd->gesture_timer);
+       push_event(rd, edge, ROTARY_EV_GESTURE, 0, ROTARY_GESTURE_LONG_END);
+       return;
+   } else {
+       ms = READ_ONCE(click_ms);
+   }
+   hrtimer_start(&rd->gesture_timer, ns_to_ktime(edge + (u64)ms * NSEC_PER_MSEC), HRTIMER_MODE_ABS);
 }
 
 static void debounce_timer_callback(struct timer_list *t)
 {
-   if(!gpio_get_value(GPIO_KEY)) key_press_event = 1;
+   struct rotary_dev *rd = from_timer(rd, t, debounce_timer);
+   unsigned long flags;
+   // 눌림 극성은 key-gpios 의 GPIO_ACTIVE_LOW 가 정한다
+   int down = gpiod_get_value(rd->key);
+
+   spin_lock_irqsave(&rd->event_lock, flags);
+   // 바운스가 원래 상태로 끝났으면 이벤트 없음
+   if (down != rd->key_down) {
+       rd->key_down = down;
+       push_event(rd, rd->key_edge_ns, ROTARY_EV_KEY, 0, down);
+       gesture_edge(rd, rd->key_edge_ns, down);
+   }
+   spin_unlock_irqrestore(&rd->event_lock, flags);
 }
 
 static irqreturn_t key_handler(int irq, void *dev_id)
 {
+    struct rotary_dev *rd = dev_id;
+
+    // 바운스 중 첫 엣지의 시각만 남긴다
+    if (!timer_pending(&rd->debounce_timer)) rd->key_edge_ns = ktime_get_ns();
     // debounce_timer 구조체가 현재 시각으로 부터 20ms를 센다.
-    mod_timer(&debounce_timer, jiffies + msecs_to_jiffies(DEBOUNCE_TIME_MS));	
+    mod_timer(&rd->debounce_timer, jiffies + msecs_to_jiffies(DEBOUNCE_TIME_MS));	
     return IRQ_HANDLED;
 }
 
 
+// 디텐트 간격이 accel_ms 보다 짧으면 그 비율만큼 (최대 accel_max) 크게 움직인다
+static int accel_steps(struct rotary_dev *rd, u64 now)
+{
+	unsigned int ms = READ_ONCE(accel_ms);
+	unsigned int max = max(READ_ONCE(accel_max), 1u);
+	u64 dt = div_u64(now - rd->last_detent_ns, NSEC_PER_MSEC);
+
+	if (!ms || dt >= ms) return 1;
+	return min_t(u64, ms / max_t(u64, dt, 1), max);
+}
+
 static irqreturn_t irq_handler(int irq, void *dev_id)
 {
-	int s1 = gpio_get_value(GPIO_S1);
-    int s2 = gpio_get_value(GPIO_S2);
-
-     if(s1 != prev_s1 || s2 != prev_s2)
-     {
-             int prev_state = (prev_s1 << 1) | prev_s2;
-             int curr_state = (s1 << 1) | s2;
-
-             //시계 방향 (00, 10, 11, 01, 00)
-             if(prev_state == 0b01 && curr_state == 0b00)
-             {
-                  if(counter < 0b1111) counter++;
-             }
-             // 반시계 방향 (00, 01, 11, 10, 00)
-             else if(prev_state == 0b10 && curr_state == 0b00)
-             {
-                  if(counter > 0) counter--;
-             }
-         prev_s1 = s1;
-         prev_s2 = s2;
-     }	
+    struct rotary_dev *rd = dev_id;
+    int s1, s2;
+    unsigned int per_detent = clamp(READ_ONCE(steps_per_detent), 1u, 4u);
+    unsigned long flags;
+    u64 now;
+    int step, dir, accel, old, detents = 0;
+
+    /*
+     * s1 과 s2 의 IRQ 스레드는 서로 다른 CPU 에서 돌 수 있다. 잠금 밖에서 읽으면
+     * 오래된 샘플이 새 샘플 뒤에 처리되어 거꾸로 가는 1/4 스텝이 생기므로 잠금 안에서 읽는다.
+     */
+    spin_lock_irqsave(&rd->event_lock, flags);
+    s1 = gpiod_get_value(rd->s1);
+    s2 = gpiod_get_value(rd->s2);
+    now = ktime_get_ns();
+    if (s1 != rd->prev_s1 || s2 != rd->prev_s2) {
+        int prev_state = (rd->prev_s1 << 1) | rd->prev_s2;
+        int curr_state = (s1 << 1) | s2;
+
+        step = quad_table[(prev_state << 2) | curr_state];
+        if (step == 2) {
+            // 너무 빨라서 중간 상태를 못 읽었다: 방향을 알면 두 스텝으로 메우고, 모르면 버린다
+            rd->glitches++;
+            step = 2 * rd->last_dir;
+        } else if (step) {
+            rd->last_dir = step;
+        }
+        rd->quarter_steps += step;
+
+        /*
+         * 디텐트 위치(풀 스텝은 00, 하프 스텝은 00 과 11)에 올 때만 센다.
+         * 반올림하므로 놓친 스텝이 있어도 디텐트는 빠지지 않고, 중간에서 되돌아간 떨림은 0 이 된다.
+         */
+        if (per_detent == 1 || curr_state == 0b00 || (per_detent == 2 && curr_state == 0b11)) {
+            detents = rd->quarter_steps / (int)per_detent;
+            if (abs(rd->quarter_steps % (int)per_detent) * 2 >= per_detent) detents += rd->quarter_steps > 0 ? 1 : -1;
+            rd->quarter_steps = 0;
+        }
+
+        for (; detents; detents -= dir) {
+            dir = detents > 0 ? 1 : -1;
+            accel = dir * accel_steps(rd, now);
+
+            // input 쪽도 가속된 값을 받아야 빠르게 돌렸을 때 같은 만큼 움직인다
+            input_set_timestamp(rd->input, ns_to_ktime(now));
+            input_report_rel(rd->input, REL_DIAL, accel);
+            input_sync(rd->input);
+
+            old = rd->counter;
+            rd->counter = clamp(rd->counter + accel, 0, COUNTER_MAX);
+            rd->last_detent_ns = now;
+            if (rd->counter != old) push_event(rd, now, ROTARY_EV_ROTATE, rd->counter - old, 0);
+        }
+        rd->prev_s1 = s1;
+        rd->prev_s2 = s2;
+    }
+    spin_unlock_irqrestore(&rd->event_lock, flags);
 	return IRQ_HANDLED;
 }
 
+// probe 의 참조, devm 이 모든 것을 푼 맨 마지막에 놓는다
+static void rotary_put(void *data)
+{
+    struct rotary_dev *rd = data;
+
+    kref_put(&rd->ref, rotary_free);
+}
+
+// devm 이 IRQ 를 푼 다음에 불린다, 그 뒤로는 타이머를 다시 거는 쪽이 없다
+static void rotary_stop_timers(void *data)
+{
+    struct rotary_dev *rd = data;
+
+    del_timer_sync(&rd->debounce_timer);
+    hrtimer_cancel(&rd->gesture_timer);
+}
+
+static int rotary_request_irq(struct rotary_dev *rd, struct device *dev, struct gpio_desc *gpio,
+                              irq_handler_t handler, const char *name)
+{
+    int irq = gpiod_to_irq(gpio);
+
+    if (irq < 0) return dev_err_probe(dev, irq, "no IRQ for %s\n", name);
+    // 양쪽 엣지: 회전은 모든 상태 변화가, 키는 눌림과 뗌이 모두 이벤트다
+    return devm_request_threaded_irq(dev, irq, NULL, handler,
+                                     IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING | IRQF_ONESHOT, name, rd);
+}
+
+static int rotary_probe(struct platform_device *pdev)
+{
+    struct device *dev = &pdev->dev;
+    struct rotary_dev *rd;
+    int id, ret;
+
+    rd = kzalloc(sizeof(*rd), GFP_KERNEL);
+    if (!rd) return -ENOMEM;
+    kref_init(&rd->ref);
+    // 가장 먼저 등록하므로 IRQ, 타이머, input 장치가 모두 풀린 뒤에 불린다
+    ret = devm_add_action_or_reset(dev, rotary_put, rd);
+    if (ret) return ret;
+
+    // s1-gpios, s2-gpios, key-gpios (선택)
+    rd->s1 = devm_gpiod_get(dev, "s1", GPIOD_IN);
+    if (IS_ERR(rd->s1)) return dev_err_probe(dev, PTR_ERR(rd->s1), "failed to get s1 gpio\n");
+    rd->s2 = devm_gpiod_get(dev, "s2", GPIOD_IN);
+    if (IS_ERR(rd->s2)) return dev_err_probe(dev, PTR_ERR(rd->s2), "failed to get s2 gpio\n");
+    rd->key = devm_gpiod_get_optional(dev, "key", GPIOD_IN);
+    if (IS_ERR(rd->key)) return dev_err_probe(dev, PTR_ERR(rd->key), "failed to get key gpio\n");
+
+    spin_lock_init(&rd->event_lock);
+    init_waitqueue_head(&rd->event_wait);
+    INIT_LIST_HEAD(&rd->readers);
+    timer_setup(&rd->debounce_timer, debounce_timer_callback, 0); // debounce_timer가 20ms가 되면 콜백함수 실행
+    hrtimer_init(&rd->gesture_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    rd->gesture_timer.function = gesture_timer_callback;
+
+    rd->prev_s1 = gpiod_get_value(rd->s1);
+    rd->prev_s2 = gpiod_get_value(rd->s2);
+    rd->key_down = rd->key ? gpiod_get_value(rd->key) : 0;
+
+    // 빈 번호를 찾아 /dev/rotary_encoder (첫 엔코더), /dev/rotary_encoder1, ... 로 만든다
+    spin_lock(&rotary_devs_lock);
+    for (id = 0; id < ROTARY_MAX_DEVICES && rotary_devs[id]; id++);
+    if (id < ROTARY_MAX_DEVICES) rotary_devs[id] = rd;
+    spin_unlock(&rotary_devs_lock);
+    if (id == ROTARY_MAX_DEVICES) return -EBUSY;
+    rd->id = id;
+
+    // input 장치 (/dev/input/eventN), 해제는 devm 이 한다
+    rd->input = devm_input_allocate_device(dev);
+    if (!rd->input) {
+        ret = -ENOMEM;
+        goto err_slot;
+    }
+    rd->input->name = "Rotary Encoder";
+    rd->input->phys = devm_kasprintf(dev, GFP_KERNEL, "rotary_encoder/input%d", id);
+    rd->input->id.bustype = BUS_HOST;
+    rd->input->id.vendor = ROTARY_INPUT_VENDOR;
+    rd->input->id.product = ROTARY_INPUT_PRODUCT;
+    input_set_capability(rd->input, EV_REL, REL_DIAL);
+    if (rd->key) input_set_capability(rd->input, EV_KEY, KEY_PLAYPAUSE);
+    ret = input_register_device(rd->input);
+    if (ret) goto err_slot;
+
+    // IRQ 보다 먼저 등록해야 IRQ 가 풀린 뒤에 타이머를 멈춘다
+    ret = devm_add_action_or_reset(dev, rotary_stop_timers, rd);
+    if (ret) goto err_slot;
+
+    ret = rotary_request_irq(rd, dev, rd->s1, irq_handler, "rotary-s1-irq");
+    if (ret) goto err_slot;
+    ret = rotary_request_irq(rd, dev, rd->s2, irq_handler, "rotary-s2-irq");
+    if (ret) goto err_slot;
+    if (rd->key) {
+        ret = rotary_request_irq(rd, dev, rd->key, key_handler, "rotary-key-irq");
+        if (ret) goto err_slot;
+    }
+
+    rd->cdev = cdev_alloc();
+    if (!rd->cdev) {
+        ret = -ENOMEM;
+        goto err_slot;
+    }
+    rd->cdev->ops = &fops;
+    rd->cdev->owner = THIS_MODULE;
+    ret = cdev_add(rd->cdev, MKDEV(MAJOR(dev_num), id), 1);
+    if (ret) goto err_cdev;
+
+    if (id) {
+        rd->dev = device_create(rotary_class, dev, MKDEV(MAJOR(dev_num), id), rd, "%s%d", DEVICE_NAME, id);
+    } else {
+        rd->dev = device_create(rotary_class, dev, MKDEV(MAJOR(dev_num), id), rd, DEVICE_NAME);
+    }
+    if (IS_ERR(rd->dev)) {
+        ret = PTR_ERR(rd->dev);
+        goto err_cdev;
+    }
+
+    platform_set_drvdata(pdev, rd);
+    dev_info(dev, "Ready at /dev/%s and as an input device.\n", dev_name(rd->dev));
+    return 0;
+
+err_cdev:
+    cdev_del(rd->cdev);
+err_slot:
+    spin_lock(&rotary_devs_lock);
+    rotary_devs[id] = NULL;
+    spin_unlock(&rotary_devs_lock);
+    // 그 사이에 연 파일이 있었다면 remove 와 같이 끝낸다
+    spin_lock_irq(&rd->event_lock);
+    rd->dead = true;
+    spin_unlock_irq(&rd->event_lock);
+    wake_up_interruptible_all(&rd->event_wait);
+    return ret;
+}
+
+/*
+ * IRQ, 타이머, input 장치는 이 함수가 끝난 뒤 devm 이 거꾸로 푼다.
+ * 아직 열려 있는 파일은 rd 를 잡고 있고, 잠든 read() 는 깨어나 -ENODEV 를 받는다.
+ */
+static void rotary_remove(struct platform_device *pdev)
+{
+    struct rotary_dev *rd = platform_get_drvdata(pdev);
+
+    spin_lock(&rotary_devs_lock);
+    rotary_devs[rd->id] = NULL;
+    spin_unlock(&rotary_devs_lock);
+
+    device_destroy(rotary_class, MKDEV(MAJOR(dev_num), rd->id));
+    cdev_del(rd->cdev);
+
+    spin_lock_irq(&rd->event_lock);
+    rd->dead = true;
+    spin_unlock_irq(&rd->event_lock);
+    wake_up_interruptible_all(&rd->event_wait);
+
+    dev_info(&pdev->dev, "Removed (%u glitches).\n", rd->glitches);
+}
+
+static const struct of_device_id rotary_of_match[] = {
+    { .compatible = "rotary-encoder-vol" },
+    {}
+};
+MODULE_DEVICE_TABLE(of, rotary_of_match);
+
+static struct platform_driver rotary_driver = {
+    .driver = { .name = DEVICE_NAME, .of_match_table = rotary_of_match },
+    .probe = rotary_probe,
+    .remove = rotary_remove,
+};
+
 static int __init rotary_encoder_init(void)
 {
+	int result;
+
 	pr_info("rotary_encoder driver : Initializing C dev...\n");
 
-	// 1. 주/부 번호 할당
-    if (alloc_chrdev_region(&dev_num, 0, 1, DEVICE_NAME) < 0) {
+	// 1. 주/부 번호 할당 (엔코더마다 하나)
+    if (alloc_chrdev_region(&dev_num, 0, ROTARY_MAX_DEVICES, DEVICE_NAME) < 0) {
         pr_err("Failed to allocate major number\n");
         return -1;
     }
     pr_info("Major number allocated: %d\n", MAJOR(dev_num));
 
-    // 2. 캐릭터 디바이스 초기화 및 등록
-    cdev_init(&my_cdev, &fops);
-    if (cdev_add(&my_cdev, dev_num, 1) < 0) {
-        pr_err("Failed to add the cdev\n");
-        unregister_chrdev_region(dev_num, 1);
-        return -1;
+    // 2. /dev/rotary_encoder* 자동 생성용 클래스 (mknod 불필요)
+    rotary_class = class_create(CLASS_NAME);
+    if (IS_ERR(rotary_class)) {
+        unregister_chrdev_region(dev_num, ROTARY_MAX_DEVICES);
+        return PTR_ERR(rotary_class);
+    }
+
+    // 3. 플랫폼 드라이버 등록, 엔코더는 Device Tree 에서 probe 된다
+    result = platform_driver_register(&rotary_driver);
+    if (result) {
+        pr_err("Failed to register the platform driver\n");
+        class_destroy(rotary_class);
+        unregister_chrdev_region(dev_num, ROTARY_MAX_DEVICES);
+        return result;
     }
 
-    pr_info("rotary_encoder driver : Ready. Create device file with 'mknod'.\n");
+    pr_info("rotary_encoder driver : loaded.\n");
     return 0;
 }
 
 static void __exit rotary_encoder_exit(void)
 {
-    cdev_del(&my_cdev);
-    unregister_chrdev_region(dev_num, 1);
+    platform_driver_unregister(&rotary_driver);
+    class_destroy(rotary_class);
+    unregister_chrdev_region(dev_num, ROTARY_MAX_DEVICES);
     pr_info("rotary_encoder driver : Character device unloaded.\n");
 }
 
@@ -189,7 +620,7 @@ module_exit(rotary_encoder_exit);
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("SYS");
-MODULE_DESCRIPTION("Rotary Encoder Driver (Manual mknod)");
+MODULE_DESCRIPTION("Rotary Encoder Driver (char device and input device)");
 
 
 
@@ -0,0 +1,29 @@
+#ifndef ROTARY_ENCODER_H
+#define ROTARY_ENCODER_H
+
+#include <linux/types.h>
+
+// /dev/rotary_encoder 의 read() 는 이 구조체를 하나 이상 돌려준다 (len 은 sizeof 의 배수로)
+struct rotary_event {
+    __u64 timestamp_ns;   // 이벤트 시각, CLOCK_MONOTONIC (clock_gettime 과 같은 시계)
+    __s32 count;          // 이벤트 후의 카운터 값 (0~15)
+    __s16 delta;          // ROTARY_EV_ROTATE: 카운트 변화 (가속 포함), + 시계방향, - 반시계방향
+    __u8 type;            // ROTARY_EV_*
+    __u8 value;           // ROTARY_EV_KEY: 1 눌림, 0 뗌 / ROTARY_EV_GESTURE: ROTARY_GESTURE_*
+};
+
+#define ROTARY_EV_ROTATE   1
+#define ROTARY_EV_KEY      2
+#define ROTARY_EV_GESTURE  3   // 제스처 창이 끝나는 즉시 (클릭은 마지막으로 뗀 뒤 click_ms)
+
+#define ROTARY_GESTURE_SINGLE      1
+#define ROTARY_GESTURE_DOUBLE      2
+#define ROTARY_GESTURE_TRIPLE      3   // 세 번 이상
+#define ROTARY_GESTURE_LONG_START  4   // long_press_ms 동안 누르고 있음
+#define ROTARY_GESTURE_LONG_END    5
+
+// input 장치 (/dev/input/eventN) 의 id, vs10xx 의 knob_volume 은 이 값으로 인코더만 골라 붙는다
+#define ROTARY_INPUT_VENDOR   0x0001
+#define ROTARY_INPUT_PRODUCT  0x5245   // "RE"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,244 @@
+// oled_bench.c (OLED 그리기 함수 호스트 측 마이크로벤치마크)
+// 사용법: make oled_bench && ./oled_bench [frames]
+//
+// oled.c 의 128x64 화면 한 장 (oled_layout_64 의 위젯 전부) 을 두 방식으로 그려 비교한다.
+//   old: 픽셀마다 경계 검사와 read-modify-write 를 하던 이전 oled_draw_pixel() 방식
+//   new: oled.c 가 쓰는 oled_draw.h 의 페이지 단위 바이트 연산 (oled_draw_span, oled_draw_column,
+//        미리 시프트한 글리프 열을 쓰는 oled_draw_run) 과 font5x7 을 그대로 include 한다
+// 두 결과 버퍼가 바이트 단위로 같아야 하고, 프레임당 연산 수와 시간을 출력한다.
+// 문자열은 oled.c 의 숫자 경로처럼 미리 시프트한 열로 그린다 (런 캐시가 맞았을 때와 같은 비용).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+static unsigned long ops_old, ops_new;
+
+#define OLED_DRAW_COUNT(n) (ops_new += (n))
+#include "oled_draw.h"
+
+#define SCREEN_HEIGHT 64
+#define SCREEN_PAGES  (SCREEN_HEIGHT / 8)
+#define FONT_CHARS    95    // font5x7: 0x20..0x7E, 5 열
+#define SPECTRUM_BANDS 32   // OLED_SPECTRUM_BANDS
+
+static uint16_t font_shifted[8][FONT_CHARS][6];   // oled_digit_cols 와 같은 형식, 6열째는 빈 열
+static const unsigned char icon_speaker[] = {
+    0x18, 0x3C, 0x3C, 0x7E, 0xC3, 0xFF, 0xFF
+};
+
+static unsigned char fb_old[SCREEN_WIDTH * SCREEN_PAGES];
+static unsigned char fb_new[SCREEN_WIDTH * SCREEN_PAGES];
+
+// ===================================================================
+// == old: 픽셀 단위 ==
+// ===================================================================
+static void old_draw_pixel(int x, int y, int color) {
+    ops_old++;
+    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
+        return;
+    }
+    if (color) {
+        fb_old[x + (y / 8) * SCREEN_WIDTH] |= (1 << (y % 8));
+    } else {
+        fb_old[x + (y / 8) * SCREEN_WIDTH] &= ~(1 << (y % 8));
+    }
+}
+
+static void old_draw_rect(int x, int y, int w, int h, int fill) {
+    int i, j;
+    for (i = x; i < x + w; i++) {
+        for (j = y; j < y + h; j++) {
+            if (fill) {
+                old_draw_pixel(i, j, 1);
+            } else if (i == x || i == x + w - 1 || j == y || j == y + h - 1) {
+                old_draw_pixel(i, j, 1);
+            }
+        }
+    }
+}
+
+static void old_clear_rect(int x, int y, int w, int h) {
+    int i, j;
+    for (i = x; i < x + w; i++) {
+        for (j = y; j < y + h; j++) {
+            old_draw_pixel(i, j, 0);
+        }
+    }
+}
+
+static void old_draw_string(int x, int y, const char *str) {
+    int i = 0, j, k;
+    while (*str) {
+        int char_idx = *str++ - ' ';
+        if (char_idx < 0 || char_idx >= FONT_CHARS) continue;
+        for (j = 0; j < 5; j++) {
+            unsigned char line = font5x7[char_idx * 5 + j];
+            for (k = 0; k < 8; k++) {
+                if ((line >> k) & 1) {
+                    old_draw_pixel(x + i * 6 + j, y + k, 1);
+                }
+            }
+        }
+        i++;
+    }
+}
+
+static void old_draw_bitmap(int x, int y, int w, int h, const unsigned char *bitmap) {
+    int i, j;
+    for (j = 0; j < h; j++) {
+        for (i = 0; i < w; i++) {
+            if ((bitmap[i] >> j) & 1) {
+                old_draw_pixel(x + i, y + j, 1);
+            }
+        }
+    }
+}
+
+// ===================================================================
+// == new: 페이지 단위 바이트 연산 (oled_draw.h, oled.c 의 oled_fill_span 등과 같은 호출) ==
+// ===================================================================
+static void new_draw_rect(int x, int y, int w, int h, int fill) {
+    oled_draw_box(fb_new, SCREEN_HEIGHT, x, y, w, h, fill);
+}
+
+static void new_clear_rect(int x, int y, int w, int h) {
+    oled_draw_span(fb_new, SCREEN_HEIGHT, x, y, w, h, 0);
+}
+
+static void new_draw_string(int x, int y, const char *str) {
+    int char_idx;
+
+    for (; *str; str++) {
+        char_idx = *str - ' ';
+        if (char_idx < 0 || char_idx >= FONT_CHARS) continue;
+        oled_draw_run(fb_new, SCREEN_HEIGHT, x, y, font_shifted[y & 7][char_idx], 6);
+        x += 6;
+    }
+}
+
+static void new_draw_bitmap(int x, int y, int w, int h, const unsigned char *bitmap) {
+    int i;
+    unsigned char mask = h >= 8 ? 0xFF : (1 << h) - 1;
+    for (i = 0; i < w; i++) {
+        oled_draw_column(fb_new, SCREEN_HEIGHT, x + i, y, bitmap[i] & mask);
+    }
+}
+
+// ===================================================================
+// == 한 화면: oled_layout_64 의 위젯을 전부 지우고 다시 그린다 ==
+// ===================================================================
+struct frame {
+    unsigned char volume[5];
+    unsigned char spectrum[SPECTRUM_BANDS];
+    int progress;             // 0..118
+    const char *clock, *track, *title, *playtime, *total;
+};
+
+#define DRAW_FRAME(pfx, f) do {                                                      \
+    int i_;                                                                         \
+    pfx##_clear_rect(2, 2, 7, 8);                                                   \
+    pfx##_draw_bitmap(2, 2, 7, 8, icon_speaker);                                    \
+    pfx##_clear_rect(10, 0, 20, 11);                                                \
+    for (i_ = 0; i_ < 5; i_++)                                                      \
+        if ((f)->volume[i_]) pfx##_draw_rect(10 + i_ * 4, 11 - (f)->volume[i_], 3, (f)->volume[i_], 1); \
+    pfx##_clear_rect(48, 2, 30, 8);                                                 \
+    pfx##_draw_string(48, 2, (f)->clock);                                           \
+    pfx##_clear_rect(90, 2, 38, 8);                                                 \
+    pfx##_draw_string(90, 2, (f)->track);                                           \
+    pfx##_clear_rect(4, 16, 120, 5);                                                \
+    pfx##_draw_rect(4, 16, 120, 5, 0);                                              \
+    pfx##_draw_rect(5, 17, (f)->progress, 3, 1);                                    \
+    pfx##_clear_rect(0, 24, 128, 16);                                               \
+    for (i_ = 0; i_ < SPECTRUM_BANDS; i_++)                                         \
+        if ((f)->spectrum[i_]) pfx##_draw_rect(2 + i_ * 4, 40 - (f)->spectrum[i_], 3, (f)->spectrum[i_], 1); \
+    pfx##_clear_rect(0, 40, 128, 12);                                               \
+    pfx##_draw_string(64 - (int)strlen((f)->title) * 3, 44, (f)->title);           \
+    pfx##_clear_rect(4, 54, 30, 8);                                                 \
+    pfx##_draw_string(4, 54, (f)->playtime);                                        \
+    pfx##_clear_rect(90, 54, 30, 8);                                                \
+    pfx##_draw_string(90, 54, (f)->total);                                          \
+} while (0)
+
+static void old_frame(const struct frame *f) { DRAW_FRAME(old, f); }
+static void new_frame(const struct frame *f) { DRAW_FRAME(new, f); }
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define NFRAMES 64
+
+int main(int argc, char *argv[]) {
+    static struct frame frames[NFRAMES];
+    static const char *titles[] = { "Golden", "Like You Better", "Dirty Work", "FAMOUS" };
+    static char clocks[NFRAMES][8], tracks[NFRAMES][8], plays[NFRAMES][8];
+    unsigned long iters = argc > 1 ? strtoul(argv[1], NULL, 0) : 200000;
+    unsigned long n, per_old, per_new;
+    double t_old, t_new, t0;
+    int i, s, c, j;
+
+    srand(1);
+    // oled_digits_init() 와 같은 방식, 모든 글자에 대해
+    for (s = 0; s < 8; s++) {
+        for (c = 0; c < FONT_CHARS; c++) {
+            for (j = 0; j < 5; j++) font_shifted[s][c][j] = font5x7[c * 5 + j] << s;
+            font_shifted[s][c][5] = 0;
+        }
+    }
+
+    for (i = 0; i < NFRAMES; i++) {
+        struct frame *f = &frames[i];
+
+        for (j = 0; j < 5; j++) f->volume[j] = j < i % 6 ? 3 + j * 2 : 0;
+        for (j = 0; j < SPECTRUM_BANDS; j++) f->spectrum[j] = rand() % 17;
+        f->progress = i * 118 / (NFRAMES - 1);
+        snprintf(clocks[i], sizeof(clocks[i]), "%02d:%02d", 12 + i / 60, i % 60);
+        snprintf(tracks[i], sizeof(tracks[i]), "%d/12", i % 12 + 1);
+        snprintf(plays[i], sizeof(plays[i]), "%02d:%02d", i / 60, i % 60);
+        f->clock = clocks[i];
+        f->track = tracks[i];
+        f->title = titles[i % 4];
+        f->playtime = plays[i];
+        f->total = "03:41";
+    }
+
+    // 결과 비교: 같은 프레임 순서로 두 버퍼가 같아야 한다
+    for (i = 0; i < NFRAMES; i++) {
+        old_frame(&frames[i]);
+        new_frame(&frames[i]);
+        if (memcmp(fb_old, fb_new, sizeof(fb_old))) {
+            fprintf(stderr, "frame %d: old and new buffers differ\n", i);
+            return -1;
+        }
+    }
+    ops_old = ops_new = 0;
+    old_frame(&frames[0]);
+    new_frame(&frames[0]);
+    per_old = ops_old;
+    per_new = ops_new;
+
+    t0 = now_ns();
+    for (n = 0; n < iters; n++) old_frame(&frames[n % NFRAMES]);
+    t_old = (now_ns() - t0) / iters;
+
+    t0 = now_ns();
+    for (n = 0; n < iters; n++) new_frame(&frames[n % NFRAMES]);
+    t_new = (now_ns() - t0) / iters;
+
+    if (memcmp(fb_old, fb_new, sizeof(fb_old))) {
+        fprintf(stderr, "old and new buffers differ after the timed runs\n");
+        return -1;
+    }
+
+    printf("full 128x64 frame, %lu frames each, buffers identical\n", iters);
+    printf("old (pixel):      %6lu pixel ops/frame, %8.1f ns/frame\n", per_old, t_old);
+    printf("new (page bytes): %6lu byte ops/frame,  %8.1f ns/frame\n", per_new, t_new);
+    printf("speedup: %.1fx\n", t_old / t_new);
+    return 0;
+}
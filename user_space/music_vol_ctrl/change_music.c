@@ -7,11 +7,14 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <poll.h>
 #include <errno.h>
 #include <pthread.h>
 #include <time.h>
 #include "vs10xx.h"
 #include "oled.h"
+#include "rotary_encoder.h"
 
 // ===================================================================
 //                         
@@ -31,7 +34,8 @@ const int num_tracks = sizeof(playlist) / sizeof(playlist[0]);
 const char *vs10xx_dev_path = "/dev/vs10xx-0";
 const char *rotary_dev_path = "/dev/rotary_encoder";
 const char *oled_dev_path = "/dev/oled";
-#define CLICK_TIMEOUT_MS 300
+const char *knob_param_path = "/sys/module/vs10xx/parameters/knob_volume";
+// Ŭ  ð rotary_encoder  click_ms, long_press_ms Ķ
 // ===================================================================
 
 typedef enum { STATE_PLAYING, STATE_PAUSED } PlaybackState;
@@ -85,6 +89,17 @@ int get_mp3_duration(const char *filepath) {
     return (int)duration;
 }
 
+// vs10xx  knob_volume=1  ÷ Ŀ    ٲٹǷ ⼭ ǵ帮 ʴ´
+int knob_in_kernel(void) {
+    FILE *fp = fopen(knob_param_path, "r");
+    int c = 0;
+
+    if (fp == NULL) return 0;
+    c = fgetc(fp);
+    fclose(fp);
+    return c == 'Y' || c == '1';
+}
+
 int main(void) {
     pthread_t playback_tid, control_tid, ui_tid;
 
@@ -183,56 +198,49 @@ void *playback_thread_func(void *arg) {
 void *control_thread_func(void *arg) {
     int rotary_fd = open(rotary_dev_path, O_RDONLY);
     int vs10xx_fd = open(vs10xx_dev_path, O_WRONLY);
-    int current_count, key_event;
-    char read_buf[32];
-    int click_count = 0;
-    struct timespec last_click_time = {0, 0};
+    struct rotary_event events[16];
+    struct pollfd pfd = { .fd = rotary_fd, .events = POLLIN };
+    int current_count = -1;
+    int set_volume = !knob_in_kernel();
     
     if (rotary_fd < 0 || vs10xx_fd < 0) { /* ... */ return NULL; }
     printf("Control thread started.\n");
 
     while (keep_running_threads) {
-        lseek(rotary_fd, 0, SEEK_SET);
-        if (read(rotary_fd, read_buf, sizeof(read_buf) - 1) > 0) {
-            if (sscanf(read_buf, "%d,%d", &current_count, &key_event) == 2) {
-                pthread_mutex_lock(&state_mutex);
-                if(player_state.rotary_count != current_count) {
-                    player_state.rotary_count = current_count;
-                    int new_volume = 100 - (current_count * 5);
-                    if (new_volume < 0) new_volume = 0;
-                    if (new_volume > 100) new_volume = 100;
-                    unsigned int packed_vol = (new_volume << 8) | new_volume;
-                    ioctl(vs10xx_fd, VS10XX_SET_VOL, &packed_vol);
+        //  Ȯ  ִ 200ms  ̺Ʈ ٸ
+        if (poll(&pfd, 1, 200) > 0) {
+            ssize_t n = read(rotary_fd, events, sizeof(events));
+            int gesture = 0;
+            for (int i = 0; i < n / (ssize_t)sizeof(events[0]); i++) {
+                if (events[i].type == ROTARY_EV_ROTATE) {
+                    current_count = events[i].count;
+                } else if (events[i].type == ROTARY_EV_GESTURE) {
+                    //  / /  Ŭ ̹ ؼ â   ش
+                    gesture = events[i].value;
                 }
-                pthread_mutex_unlock(&state_mutex);
+            }
 
-                if (key_event == 1) {
-                    struct timespec now;
-                    clock_gettime(CLOCK_MONOTONIC, &now);
-                    if (get_time_diff_ms(&last_click_time, &now) > CLICK_TIMEOUT_MS) {
-                        click_count = 1;
-                    } else {
-                        click_count++;
-                    }
-                    last_click_time = now;
-                }
+            //    ȸ ̺Ʈ  īƮ ݿ
+            pthread_mutex_lock(&state_mutex);
+            if (current_count >= 0 && player_state.rotary_count != current_count) {
+                player_state.rotary_count = current_count;
+                int new_volume = 100 - (current_count * 5);
+                if (new_volume < 0) new_volume = 0;
+                if (new_volume > 100) new_volume = 100;
+                unsigned int packed_vol = (new_volume << 8) | new_volume;
+                if (set_volume) ioctl(vs10xx_fd, VS10XX_SET_VOL, &packed_vol);
             }
-        }
+            pthread_mutex_unlock(&state_mutex);
 
-        if (click_count > 0) {
-            struct timespec now;
-            clock_gettime(CLOCK_MONOTONIC, &now);
-            if (get_time_diff_ms(&last_click_time, &now) > CLICK_TIMEOUT_MS) {
+            if (gesture >= ROTARY_GESTURE_SINGLE && gesture <= ROTARY_GESTURE_TRIPLE) {
                 pthread_mutex_lock(&state_mutex);
-                if (click_count == 1) { player_state.play_state = !player_state.play_state; } 
-                else if (click_count == 2) { request_track_change = 1; player_state.song_current_sec = 0; player_state.track_current = (player_state.track_current + 1) % num_tracks; }
-                else if (click_count >= 3) { request_track_change = 1; player_state.song_current_sec = 0; player_state.track_current = (player_state.track_current - 1 + num_tracks) % num_tracks; }
+                if (gesture == ROTARY_GESTURE_SINGLE) { player_state.play_state = !player_state.play_state; } 
+                else if (gesture == ROTARY_GESTURE_DOUBLE) { request_track_change = 1; player_state.song_current_sec = 0; player_state.track_current = (player_state.track_current + 1) % num_tracks; }
+                else { request_track_change = 1; player_state.song_current_sec = 0; player_state.track_current = (player_state.track_current - 1 + num_tracks) % num_tracks; }
                 if(player_state.play_state == STATE_PLAYING) pthread_cond_signal(&player_cond);
                 pthread_mutex_unlock(&state_mutex);
-                click_count = 0;
             }
         }
-        usleep(50000);
     }
     close(rotary_fd);
     close(vs10xx_fd);
@@ -245,10 +253,21 @@ void *control_thread_func(void *arg) {
 //                        UI Ʈ 
 // ===================================================================
 void *ui_thread_func(void *arg) {
-    int oled_fd = open(oled_dev_path, O_WRONLY);
+    int oled_fd = open(oled_dev_path, O_RDWR);
     if (oled_fd < 0) { perror("UI: Failed to open oled"); return NULL; }
+
+    // Ʈ   , VS10xx ÷   ⿡   ̹ ִϸ̼
+    struct oled_levels *levels = mmap(NULL, sizeof(struct oled_levels), PROT_READ | PROT_WRITE, MAP_SHARED, oled_fd, 0);
+    if (levels == MAP_FAILED) levels = NULL;
+    int vs_fd = open(vs10xx_dev_path, O_WRONLY);
+    if (vs_fd >= 0) {
+        unsigned int rate = 10;
+        ioctl(vs_fd, VS10XX_SET_SPECTRUM, &rate);
+    }
     
-    struct mp3_ui_data ui_data;
+    struct mp3_ui_data ui_data, prev;
+    char title[OLED_TITLE_MAX], prev_title[OLED_TITLE_MAX];
+    int first = 1;
     
     while (keep_running_threads) {
         // ---   UI ͷ ϰ  ---
@@ -263,8 +282,14 @@ void *ui_thread_func(void *arg) {
         // --- UI  ü ä ---
         memset(&ui_data, 0, sizeof(ui_data));
         
-        // 1. 
-        ui_data.volume = count; // 0-100 0-15 ȯ
+        // 1. : ӵ ȸ īƮ Ŀ  ߳ ʰ ̹   д´
+        unsigned int sci_vol;
+        if (vs_fd >= 0 && ioctl(vs_fd, VS10XX_GET_VOL, &sci_vol) == 0) {
+            int level = (100 - (int)(sci_vol >> 8)) / 5; //   100 - count * 5  Ųٷ
+            ui_data.volume = level < 0 ? 0 : level > 15 ? 15 : level;
+        } else {
+            ui_data.volume = count;
+        }
         
         // 2.  ð
         time_t t = time(NULL); struct tm *tm = localtime(&t);
@@ -281,23 +306,55 @@ void *ui_thread_func(void *arg) {
         
         // 6.   (ο  ̸ )
         const char *last_slash = strrchr(playlist[track_idx], '/');
-        if (last_slash) {
-            strncpy(ui_data.song_title, last_slash + 1, sizeof(ui_data.song_title) - 1);
-        } else {
-            strncpy(ui_data.song_title, playlist[track_idx], sizeof(ui_data.song_title) - 1);
-        }
+        snprintf(title, sizeof(title), "%s", last_slash ? last_slash + 1 : playlist[track_idx]);
+        strncpy(ui_data.song_title, title, sizeof(ui_data.song_title) - 1);
         
         // 7. ü ð
         snprintf(ui_data.total_time, sizeof(ui_data.total_time), "%02d:%02d", total_sec / 60, total_sec % 60);
 
+        // 4. Ʈ (÷  nbands  0 ̹Ƿ   )
+        struct vs10xx_spectrum sa;
+        int have_levels = 0;
+        if (levels && vs_fd >= 0 && ioctl(vs_fd, VS10XX_GET_SPECTRUM, &sa) == 0 && sa.nbands > 0) {
+            for (unsigned int i = 0; i < sa.nbands && i < OLED_SPECTRUM_BANDS; i++) {
+                levels->levels[i] = sa.bands[i] >> 2; // 0~63 -> 0~15
+            }
+            __sync_synchronize();
+            levels->seq++;
+            have_levels = 1;
+        }
+
         // --- OLED ̹   ---
-        if (write(oled_fd, &ui_data, sizeof(ui_data)) < 0) {
-            perror("UI: Failed to write to oled device");
+        // ó ü , Ŀ ٲ ׸ ioctl  
+        if (first) {
+            if (write(oled_fd, &ui_data, sizeof(ui_data)) < 0) {
+                perror("UI: Failed to write to oled device");
+            }
+            ioctl(oled_fd, OLED_SET_TITLE, title);
+            first = 0;
+        } else {
+            if (ui_data.volume != prev.volume) ioctl(oled_fd, OLED_SET_VOLUME, &ui_data.volume);
+            if (strcmp(ui_data.current_time, prev.current_time)) ioctl(oled_fd, OLED_SET_CLOCK, ui_data.current_time);
+            if (ui_data.track_current != prev.track_current || ui_data.track_total != prev.track_total) {
+                struct oled_track track = { ui_data.track_current, ui_data.track_total };
+                ioctl(oled_fd, OLED_SET_TRACK, &track);
+            }
+            //     Ź ,   ̹ ˾Ƽ ִϸ̼
+            if ((!ui_data.spectrum_run_stop && !have_levels) || ui_data.spectrum_run_stop != prev.spectrum_run_stop) {
+                ioctl(oled_fd, OLED_SET_SPECTRUM_RUN, &ui_data.spectrum_run_stop);
+            }
+            if (strcmp(ui_data.playback_time, prev.playback_time)) ioctl(oled_fd, OLED_SET_PLAYBACK_TIME, ui_data.playback_time);
+            if (strcmp(title, prev_title)) ioctl(oled_fd, OLED_SET_TITLE, title);
+            if (strcmp(ui_data.total_time, prev.total_time)) ioctl(oled_fd, OLED_SET_TOTAL_TIME, ui_data.total_time);
         }
+        prev = ui_data;
+        strcpy(prev_title, title);
         
         usleep(100000); // 0.1ʸ ȭ Ʈ
     }
     
+    if (levels) munmap(levels, sizeof(struct oled_levels));
+    if (vs_fd >= 0) close(vs_fd);
     close(oled_fd);
     printf("UI thread finished.\n");
     return NULL;
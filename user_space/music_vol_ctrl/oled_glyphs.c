@@ -0,0 +1,186 @@
+// oled_glyphs.c (BDF 폰트 -> OLED 글리프 아틀라스 변환)
+// 사용법: ./oled_glyphs font.bdf oled-glyphs.bin [first-last ...]
+//   예) ./oled_glyphs gulim8.bdf oled-glyphs.bin 0xAC00-0xD7A3 0x3131-0x318E
+//       sudo cp oled-glyphs.bin /lib/firmware/
+//
+// oled-glyphs.bin 형식 (oled.ko 의 glyph_firmware, 모두 little endian):
+//   헤더   char magic[4] = "OLG1"; u32 count;
+//   레코드 count 개, 코드 포인트 오름차순, 중복 없음, 레코드당 16 바이트
+//          u32 cp;         유니코드 코드 포인트
+//          u8  width;      1..11 열
+//          u8  cols[11];   열마다 8 픽셀 (페이지 배치, LSB 가 맨 위), width 이후는 0
+// ASCII (0x20..0x7F) 는 드라이버 내장 font5x7 을 쓰므로 건너뛴다.
+// 글리프는 FONT_ASCENT 를 기준선으로 8 줄 셀에 놓이고, 셀 밖 픽셀과 11 열을 넘는 열은 잘린다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define GLYPH_ROWS   8
+#define GLYPH_MAX_W  11   // OLED_GLYPH_MAX_W
+#define GLYPH_MAGIC  "OLG1"
+#define MAX_RANGES   16
+
+struct glyph {
+    uint32_t cp;
+    uint8_t width;
+    uint8_t cols[GLYPH_MAX_W];
+};
+
+struct range {
+    uint32_t first, last;
+};
+
+static struct range ranges[MAX_RANGES];
+static int nranges;
+
+static int wanted(long cp) {
+    int i;
+
+    if (cp < 0x80 || cp > 0x10FFFF) return 0;
+    if (!nranges) return 1;
+    for (i = 0; i < nranges; i++) {
+        if (cp >= ranges[i].first && cp <= ranges[i].last) return 1;
+    }
+    return 0;
+}
+
+static int cmp_glyph(const void *a, const void *b) {
+    const struct glyph *x = a, *y = b;
+
+    return x->cp < y->cp ? -1 : x->cp > y->cp;
+}
+
+static void put_le32(unsigned char *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+int main(int argc, char *argv[]) {
+    FILE *in, *out;
+    char line[256];
+    struct glyph *glyphs = NULL, *g;
+    size_t count = 0, cap = 0, i, n;
+    long cp = -1;
+    int ascent = -1, bbx_w = 0, bbx_h = 0, bbx_x = 0, bbx_y = 0;
+    int in_bitmap = 0, row = 0, cut = 0, clipped = 0, x, top;
+    unsigned long bits;
+    unsigned char hdr[8], rec[16];
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s font.bdf oled-glyphs.bin [first-last ...]\n", argv[0]);
+        return -1;
+    }
+    for (i = 3; i < (size_t)argc && nranges < MAX_RANGES; i++) {
+        char *end;
+
+        ranges[nranges].first = strtoul(argv[i], &end, 0);
+        ranges[nranges].last = *end == '-' ? strtoul(end + 1, NULL, 0) : ranges[nranges].first;
+        nranges++;
+    }
+
+    in = fopen(argv[1], "r");
+    if (!in) {
+        perror("Failed to open the BDF font");
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), in)) {
+        if (!strncmp(line, "FONT_ASCENT ", 12)) {
+            ascent = atoi(line + 12);
+        } else if (!strncmp(line, "FONTBOUNDINGBOX ", 16) && ascent < 0) {
+            int w, h, xo, yo;
+
+            if (sscanf(line + 16, "%d %d %d %d", &w, &h, &xo, &yo) == 4) ascent = h + yo;
+        } else if (!strncmp(line, "ENCODING ", 9)) {
+            cp = strtol(line + 9, NULL, 10);
+        } else if (!strncmp(line, "BBX ", 4)) {
+            sscanf(line + 4, "%d %d %d %d", &bbx_w, &bbx_h, &bbx_x, &bbx_y);
+        } else if (!strncmp(line, "BITMAP", 6)) {
+            if (!wanted(cp)) continue;
+            if (count == cap) {
+                cap = cap ? cap * 2 : 1024;
+                glyphs = realloc(glyphs, cap * sizeof(*glyphs));
+                if (!glyphs) {
+                    perror("realloc");
+                    return -1;
+                }
+            }
+            g = &glyphs[count++];
+            memset(g, 0, sizeof(*g));
+            g->cp = cp;
+            x = bbx_x > 0 ? bbx_x : 0;
+            g->width = x + bbx_w > GLYPH_MAX_W ? GLYPH_MAX_W : x + bbx_w;
+            if (!g->width) g->width = 1;
+            cut = x + bbx_w > GLYPH_MAX_W;
+            in_bitmap = 1;
+            row = 0;
+        } else if (!strncmp(line, "ENDCHAR", 7)) {
+            if (in_bitmap && cut) clipped++;
+            in_bitmap = 0;
+            cut = 0;
+            cp = -1;
+        } else if (in_bitmap) {
+            // BDF 한 줄 = 왼쪽 정렬된 16진수 비트맵, 위에서부터 한 줄씩
+            g = &glyphs[count - 1];
+            top = (ascent < 0 ? GLYPH_ROWS - 1 : ascent) - (bbx_y + bbx_h);
+            bits = strtoul(line, NULL, 16);
+            n = strcspn(line, "\r\n") * 4;
+            if (top + row < 0 || top + row >= GLYPH_ROWS) {
+                if (bits) cut = 1;
+            } else {
+                for (x = 0; x < bbx_w; x++) {
+                    int col = (bbx_x > 0 ? bbx_x : 0) + x;
+
+                    if (!(bits >> (n - 1 - x) & 1) || col >= GLYPH_MAX_W) continue;
+                    g->cols[col] |= 1 << (top + row);
+                }
+            }
+            row++;
+        }
+    }
+    fclose(in);
+
+    if (!count) {
+        fprintf(stderr, "%s: no glyphs outside ASCII in the requested ranges\n", argv[1]);
+        free(glyphs);
+        return -1;
+    }
+
+    // 드라이버는 이진 탐색을 하므로 오름차순, 같은 코드 포인트는 하나만 남긴다
+    qsort(glyphs, count, sizeof(*glyphs), cmp_glyph);
+    for (i = 1, n = 1; i < count; i++) {
+        if (glyphs[i].cp != glyphs[n - 1].cp) glyphs[n++] = glyphs[i];
+    }
+    count = n;
+
+    out = fopen(argv[2], "wb");
+    if (!out) {
+        perror("Failed to create the atlas");
+        free(glyphs);
+        return -1;
+    }
+    memcpy(hdr, GLYPH_MAGIC, 4);
+    put_le32(hdr + 4, count);
+    fwrite(hdr, sizeof(hdr), 1, out);
+    for (i = 0; i < count; i++) {
+        put_le32(rec, glyphs[i].cp);
+        rec[4] = glyphs[i].width;
+        memcpy(rec + 5, glyphs[i].cols, GLYPH_MAX_W);
+        fwrite(rec, sizeof(rec), 1, out);
+    }
+    if (fclose(out)) {
+        perror("Failed to write the atlas");
+        free(glyphs);
+        return -1;
+    }
+
+    printf("%zu glyphs written to %s", count, argv[2]);
+    if (clipped) printf(", %d clipped to %dx%d", clipped, GLYPH_MAX_W, GLYPH_ROWS);
+    printf("\n");
+    free(glyphs);
+    return 0;
+}
@@ -16,4 +16,82 @@
  */
 #define VS10XX_SET_VOL _IOW(VS10XX_IOCTL_BASE, 1, unsigned int)
 
+/* 스펙트럼 분석기 플러그인 밴드 값 (VS10XX_GET_SPECTRUM) */
+#define VS10XX_SA_MAX_BANDS 32
+
+struct vs10xx_spectrum {
+    unsigned int seq;       /* 새 값이 읽힐 때마다 증가 */
+    unsigned int nbands;    /* 플러그인이 응답하기 전에는 0 */
+    unsigned char bands[VS10XX_SA_MAX_BANDS];
+};
+
+#define VS10XX_SET_SPECTRUM _IOW(VS10XX_IOCTL_BASE, 3, unsigned int)
+#define VS10XX_GET_SPECTRUM _IOR(VS10XX_IOCTL_BASE, 4, struct vs10xx_spectrum)
+
+/* 디코더 워치독 통계 (VS10XX_GET_WDSTATS) */
+struct vs10xx_wd_stats {
+    unsigned int recoveries;        /* 성공한 복구 횟수 */
+    unsigned int starvations;       /* DREQ 정체로 인한 복구 */
+    unsigned int stalls;            /* 디코드 시간 정체로 인한 복구 */
+    unsigned int failures;          /* 복구 실패 */
+    unsigned int last_recovery_us;  /* 마지막 복구 소요 시간 */
+    unsigned int dropped_bytes;     /* 프레임 경계까지 건너뛴 바이트 */
+};
+
+#define VS10XX_GET_WDSTATS _IOR(VS10XX_IOCTL_BASE, 5, struct vs10xx_wd_stats)
+
+/*
+ * open() 한 파일마다 별도의 스트림이 생긴다 (VS10XX_SET_STREAM)
+ * priority 가 높은 스트림이 프레임 경계에서 낮은 스트림을 선점하고,
+ * 끝나면 낮은 스트림이 다음 프레임부터 이어서 재생된다.
+ */
+struct vs10xx_stream_cfg {
+    int priority;           /* 클수록 우선, 기본값 0 */
+    unsigned int duck_db;   /* 이 스트림이 끝난 뒤 재개되는 스트림을 -duck_db 에서 서서히 복원 */
+};
+
+#define VS10XX_SET_STREAM _IOW(VS10XX_IOCTL_BASE, 6, struct vs10xx_stream_cfg)
+
+/*
+ * SPI 버스 자가 측정 (VS10XX_BENCH)
+ * 재생 중인 데이터가 큐에 남아 있으면 EBUSY, 0 으로 두면 기본값 사용
+ */
+struct vs10xx_bench {
+    unsigned int sdi_bytes;           /* 보낼 바이트 수 (기본 64 KiB, 최대 1 MiB) */
+    unsigned int sci_reads;           /* SCI 읽기 횟수 (기본 256) */
+
+    unsigned int sdi_bytes_per_sec;   /* DREQ 대기 포함 처리량 */
+    unsigned int sdi_p50_ns;          /* 32바이트 전송 1회 지연 */
+    unsigned int sdi_p99_ns;
+    unsigned int sci_p50_ns;          /* SCI_STATUS 읽기 1회 지연 */
+    unsigned int sci_p99_ns;
+    unsigned int dreq_duty_permille;  /* 전송 시간 중 DREQ 가 high 였던 비율 (1/1000) */
+};
+
+#define VS10XX_BENCH _IOWR(VS10XX_IOCTL_BASE, 7, struct vs10xx_bench)
+
+/* 감지된 칩 정보와 현재 SPI 속도 (VS10XX_GET_INFO) */
+#define VS10XX_CODEC_MP3    (1 << 0)
+#define VS10XX_CODEC_WMA    (1 << 1)
+#define VS10XX_CODEC_MIDI   (1 << 2)
+#define VS10XX_CODEC_WAV    (1 << 3)
+#define VS10XX_CODEC_AAC    (1 << 4)
+#define VS10XX_CODEC_OGG    (1 << 5)
+
+struct vs10xx_info {
+    unsigned int version;   /* SCI_STATUS 의 버전 (3: VS1003, 4: VS1053) */
+    char name[16];          /* 적용된 설정 이름 */
+    unsigned int codecs;    /* VS10XX_CODEC_* */
+    unsigned int sci_hz;    /* 제어용 SPI 속도 */
+    unsigned int sdi_hz;    /* 데이터용 SPI 속도 */
+};
+
+#define VS10XX_GET_INFO _IOR(VS10XX_IOCTL_BASE, 8, struct vs10xx_info)
+
+/*
+ * 실제로 적용된 볼륨 (VS10XX_GET_VOL), VS10XX_SET_VOL 과 같은 (left << 8) | right 형식
+ * knob_volume 으로 커널이 바꾼 값도 포함한다, 덕킹 감쇠는 빠진 값
+ */
+#define VS10XX_GET_VOL _IOR(VS10XX_IOCTL_BASE, 9, unsigned int)
+
 #endif /* VS10XX_H */
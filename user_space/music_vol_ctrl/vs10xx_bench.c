@@ -0,0 +1,48 @@
+// vs10xx_bench.c (SPI 버스 자가 측정)
+// 사용법: ./vs10xx_bench [sdi_bytes] [sci_reads]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "vs10xx.h"
+
+#define DEVICE_PATH "/dev/vs10xx-0"
+
+int main(int argc, char *argv[]) {
+    int fd;
+    struct vs10xx_bench bench;
+    struct vs10xx_info info;
+
+    memset(&bench, 0, sizeof(bench));
+    if (argc > 1) bench.sdi_bytes = strtoul(argv[1], NULL, 0);
+    if (argc > 2) bench.sci_reads = strtoul(argv[2], NULL, 0);
+
+    fd = open(DEVICE_PATH, O_WRONLY);
+    if (fd < 0) {
+        perror("Failed to open the device file");
+        return -1;
+    }
+
+    if (ioctl(fd, VS10XX_GET_INFO, &info) == 0) {
+        printf("%s (version %u), SCI %u Hz, SDI %u Hz\n", info.name, info.version, info.sci_hz, info.sdi_hz);
+    }
+
+    // 재생 중이면 드라이버가 EBUSY 를 돌려준다
+    if (ioctl(fd, VS10XX_BENCH, &bench) < 0) {
+        perror("VS10XX_BENCH failed");
+        close(fd);
+        return -1;
+    }
+
+    printf("SDI: %u bytes, %u bytes/s, DREQ duty %u.%u%%\n",
+           bench.sdi_bytes, bench.sdi_bytes_per_sec,
+           bench.dreq_duty_permille / 10, bench.dreq_duty_permille % 10);
+    printf("SDI 32-byte burst: p50 %u ns, p99 %u ns\n", bench.sdi_p50_ns, bench.sdi_p99_ns);
+    printf("SCI read (%u): p50 %u ns, p99 %u ns\n", bench.sci_reads, bench.sci_p50_ns, bench.sci_p99_ns);
+
+    close(fd);
+    return 0;
+}